@@ -0,0 +1,118 @@
+
+/*
+ * Contention benchmark for ConcurrentObjectArrayAllocator.
+ *
+ * Every thread repeatedly allocates a handful of objects, touches them and
+ * frees them again. The same workload is run against
+ *
+ *   - an ObjectArrayAllocator behind a std::mutex
+ *   - the lock-free shared stack of ConcurrentObjectArrayAllocator
+ *   - ConcurrentObjectArrayAllocator with a Magazine per thread
+ *
+ * for 1 to 8 threads. Throughput is printed in millions of alloc/free pairs
+ * per second.
+ */
+
+#include <etk/etk.h>
+#include <etk/concurrent_objpool.h>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <vector>
+
+
+using namespace std;
+using namespace etk;
+
+
+struct Message
+{
+	uint32 id;
+	uint8 payload[60];
+};
+
+static const uint32 N_OBJECTS = 4096;
+static const uint32 ITERATIONS = 200000;
+static const uint32 HELD = 8;
+
+
+// an ObjectArrayAllocator with a lock around it
+class LockedAllocator
+{
+public:
+	Message* alloc()
+	{
+		lock_guard<mutex> lock(m);
+		return allocator.alloc();
+	}
+
+	bool free(Message* msg)
+	{
+		lock_guard<mutex> lock(m);
+		return allocator.free(msg);
+	}
+
+private:
+	mutex m;
+	ObjectArrayAllocator<Message, N_OBJECTS> allocator;
+};
+
+typedef ConcurrentObjectArrayAllocator<Message, N_OBJECTS> SharedAllocator;
+
+
+template <typename A> void work(A& allocator, uint32 id)
+{
+	Message* held[HELD];
+	for(uint32 i = 0; i < ITERATIONS; i++)
+	{
+		uint32 n = 0;
+		for(; n < HELD; n++)
+		{
+			held[n] = allocator.alloc();
+			if(held[n] == nullptr)
+				break;
+			held[n]->id = id;
+		}
+		for(uint32 j = 0; j < n; j++)
+			allocator.free(held[j]);
+	}
+}
+
+
+template <typename F> double run(uint32 n_threads, F f)
+{
+	vector<thread> threads;
+	auto start = chrono::steady_clock::now();
+	for(uint32 t = 0; t < n_threads; t++)
+		threads.push_back(thread(f, t));
+	for(auto& t : threads)
+		t.join();
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+	double ops = double(n_threads) * ITERATIONS * HELD;
+	return ops / elapsed.count() / 1e6;
+}
+
+
+int main()
+{
+	static LockedAllocator locked;
+	static SharedAllocator shared;
+
+	cout << "threads    mutex    lock-free    magazine   (M alloc+free/s)" << endl;
+	for(uint32 n = 1; n <= 8; n *= 2)
+	{
+		double a = run(n, [](uint32 id) { work(locked, id); });
+		double b = run(n, [](uint32 id) { work(shared, id); });
+		double c = run(n, [](uint32 id) {
+			SharedAllocator::Magazine<32> mag(shared);
+			work(mag, id);
+		});
+
+		cout << setw(7) << n << fixed << setprecision(1)
+			<< setw(9) << a << setw(13) << b << setw(12) << c << endl;
+	}
+}
+
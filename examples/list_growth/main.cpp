@@ -0,0 +1,66 @@
+/*
+ * Appends 10,000 items to each of two DynamicLists under different growth
+ * policies and prints how long it took and how many times the pool was asked
+ * to realloc. The lists are appended to in turn, so they get in each other's
+ * way and a realloc often has to move a list.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+
+using namespace std;
+using namespace etk;
+
+
+static const int ITEMS = 10000;
+
+typedef MemPool<1024*256, 64> PoolType;
+static PoolType pool;
+
+
+// counts the reallocs that reach the pool
+class CountingPool : public Pool
+{
+public:
+	void* alloc(uint32 sz) { return pool.alloc(sz); }
+	void free(void* ptr) { pool.free(ptr); }
+	void* realloc(void* ptr, uint32 sz) { reallocs++; return pool.realloc(ptr, sz); }
+	uint32 coalesce() { return pool.coalesce(); }
+	uint32 ref(void* ptr) { return pool.ref(ptr); }
+	uint32 unref(void* ptr) { return pool.unref(ptr); }
+
+	uint32 reallocs = 0;
+};
+
+
+template <typename GROWTH> void run(const char* name)
+{
+	CountingPool counting;
+	auto start = chrono::steady_clock::now();
+	{
+		DynamicList<int, 1, Pool, GROWTH> a(&counting);
+		DynamicList<int, 1, Pool, GROWTH> b(&counting);
+		for(int i = 0; i < ITEMS; i++)
+		{
+			a.append(i);
+			b.append(i);
+		}
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+	cout << left << setw(22) << name << right << fixed << setprecision(3)
+		<< setw(10) << elapsed.count()*1000.0 << " ms"
+		<< setw(10) << counting.reallocs << " reallocs" << endl;
+}
+
+
+int main()
+{
+	run<LinearGrowth<1>>("LinearGrowth<1>");
+	run<LinearGrowth<16>>("LinearGrowth<16>");
+	run<LinearGrowth<256>>("LinearGrowth<256>");
+	run<GeometricGrowth<4>>("GeometricGrowth<4>");
+}
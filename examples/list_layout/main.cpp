@@ -0,0 +1,67 @@
+/*
+ * Builds a long SingleLinkedList by inserting items at random places, so
+ * that its nodes end up scattered across the slabs, and times how
+ * long it takes to add up every item. It then times the same walk after
+ * defragment(), and over an UnrolledLinkedList holding the same items.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <stdlib.h>
+
+
+using namespace std;
+using namespace etk;
+
+
+static const uint32 ITEMS = 50000;
+static const uint32 PASSES = 20;
+
+typedef MemPool<1024*1024*16, 64> PoolType;
+
+
+template <typename L> double time_walk(L& list)
+{
+	volatile int64 sink = 0;
+	auto start = chrono::steady_clock::now();
+	for(uint32 p = 0; p < PASSES; p++)
+	{
+		int64 sum = 0;
+		for(auto iter = list.begin(); iter; iter++)
+			sum += *iter;
+		sink = sink + sum;
+	}
+	chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+	return elapsed.count() / (double(PASSES) * ITEMS);
+}
+
+
+int main()
+{
+	static PoolType pool;
+	SingleLinkedList<int32, 64, PoolType> list(&pool);
+
+	// insert every item at a random place, so that the list order has
+	// nothing to do with the order the nodes were handed out in
+	srand(1);
+	for(uint32 n = 0; n < ITEMS; n++)
+		list.insert(rand(), rand() % (n + 1));
+
+	UnrolledLinkedList<int32, 32, 16, PoolType> unrolled(&pool);
+	for(auto iter = list.begin(); iter; iter++)
+		unrolled.append(*iter);
+
+	cout << fixed << setprecision(2);
+	cout << "items                     " << ITEMS << endl;
+	cout << "scattered nodes           " << time_walk(list) << " ns/item" << endl;
+
+	auto start = chrono::steady_clock::now();
+	bool ok = list.defragment();
+	chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+	cout << "defragment()              " << elapsed.count() << " ms" << (ok ? "" : " (out of memory)") << endl;
+
+	cout << "defragmented nodes        " << time_walk(list) << " ns/item" << endl;
+	cout << "unrolled, 32 per node     " << time_walk(unrolled) << " ns/item" << endl;
+}
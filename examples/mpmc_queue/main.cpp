@@ -0,0 +1,163 @@
+/*
+ * Throughput benchmark for MpmcQueue.
+ *
+ * Half of the threads put samples on to a queue and the other half take them
+ * off. The same workload is run against
+ *
+ *   - a RingBuffer behind a std::mutex
+ *   - MpmcQueue
+ *
+ * for 2 to 16 threads, plus a single thread doing both. Throughput is printed
+ * in millions of samples per second.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+
+using namespace std;
+using namespace etk;
+
+
+struct Sample
+{
+	uint32 sensor;
+	float value;
+};
+
+static const uint32 QUEUE_SIZE = 1024;
+static const uint32 SAMPLES = 2000000;
+
+
+// a RingBuffer with a lock around it
+class LockedQueue
+{
+public:
+	LockedQueue() : rb(buffer, QUEUE_SIZE)
+	{
+	}
+
+	bool try_put(const Sample& s)
+	{
+		lock_guard<mutex> lock(m);
+		if(rb.is_full())
+			return false;
+		rb.put(s);
+		return true;
+	}
+
+	bool try_get(Sample& s)
+	{
+		lock_guard<mutex> lock(m);
+		if(rb.available() == 0)
+			return false;
+		s = rb.get();
+		return true;
+	}
+
+private:
+	mutex m;
+	Sample buffer[QUEUE_SIZE];
+	RingBuffer<Sample> rb;
+};
+
+class LockFreeQueue
+{
+public:
+	LockFreeQueue() : q(buffer, sequence, QUEUE_SIZE)
+	{
+	}
+
+	bool try_put(const Sample& s)
+	{
+		return q.try_put(s);
+	}
+
+	bool try_get(Sample& s)
+	{
+		return q.try_get(s);
+	}
+
+private:
+	Sample buffer[QUEUE_SIZE];
+	atomic<uint32> sequence[QUEUE_SIZE];
+	MpmcQueue<Sample> q;
+};
+
+
+template <typename Q> double run(uint32 n_threads)
+{
+	static Q q;
+	uint32 producers = (n_threads > 1) ? n_threads/2 : 1;
+	uint32 consumers = (n_threads > 1) ? n_threads - producers : 1;
+	uint32 per_producer = SAMPLES / producers;
+	atomic<uint32> remaining(per_producer * producers);
+
+	auto produce = [&](uint32 id) {
+		Sample s;
+		s.sensor = id;
+		for(uint32 i = 0; i < per_producer; i++)
+		{
+			s.value = i;
+			while(!q.try_put(s))
+				this_thread::yield();
+		}
+	};
+	auto consume = [&]() {
+		Sample s;
+		while(remaining.load(memory_order_relaxed) > 0)
+		{
+			if(q.try_get(s))
+				remaining.fetch_sub(1, memory_order_relaxed);
+			else
+				this_thread::yield();
+		}
+	};
+
+	auto start = chrono::steady_clock::now();
+	if(n_threads == 1)
+	{
+		// one thread fills and drains the queue in turn
+		Sample s = {0, 0.0f};
+		for(uint32 i = 0; i < SAMPLES; i += QUEUE_SIZE/2)
+		{
+			for(uint32 j = 0; j < QUEUE_SIZE/2; j++)
+				q.try_put(s);
+			for(uint32 j = 0; j < QUEUE_SIZE/2; j++)
+				q.try_get(s);
+		}
+	}
+	else
+	{
+		vector<thread> threads;
+		for(uint32 t = 0; t < producers; t++)
+			threads.push_back(thread(produce, t));
+		for(uint32 t = 0; t < consumers; t++)
+			threads.push_back(thread(consume));
+		for(auto& t : threads)
+			t.join();
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+	return SAMPLES / elapsed.count() / 1e6;
+}
+
+
+int main()
+{
+	cout << "threads    mutex    lock-free   (M samples/s)" << endl;
+	for(uint32 n = 1; n <= 16; n *= 2)
+	{
+		double a = run<LockedQueue>(n);
+		double b = run<LockFreeQueue>(n);
+
+		cout << setw(7) << n << fixed << setprecision(1)
+			<< setw(9) << a << setw(12) << b << endl;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ * Throughput of number formatting, against snprintf.
+ *
+ * The same numbers are written with snprintf, with the etk format functions
+ * and with Rope, which has to copy the result in to its buffer. The
+ * shortest float mode is compared with "%.9g", which always writes nine
+ * significant digits but is the nearest snprintf gets to round tripping.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <stdio.h>
+
+
+using namespace std;
+using namespace etk;
+
+
+static const uint32 COUNT = 1 << 16;
+static const uint32 PASSES = 20;
+
+static uint32 u32s[COUNT];
+static int64 i64s[COUNT];
+static float floats[COUNT];
+
+static volatile uint32 sink = 0;
+
+
+template <typename F> double time_it(F f)
+{
+	auto start = chrono::steady_clock::now();
+	for(uint32 p = 0; p < PASSES; p++)
+	{
+		for(uint32 i = 0; i < COUNT; i++)
+			sink = sink + f(i);
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	return double(COUNT) * PASSES / elapsed.count() / 1e6;
+}
+
+
+int main()
+{
+	uint32 seed = 1;
+	for(uint32 i = 0; i < COUNT; i++)
+	{
+		seed = seed*1664525 + 1013904223;
+		u32s[i] = seed >> (seed & 31);
+		i64s[i] = int64(seed)*int64(seed) - (int64(1) << 62);
+		floats[i] = float(int32(seed)) / 65536.0f;
+	}
+
+	char buf[64];
+	Rope rope(buf, 64);
+
+	cout << "                snprintf      etk     Rope   (M numbers/s)" << endl;
+	cout << fixed << setprecision(1);
+
+	cout << "uint32    " << setw(14) << time_it([&](uint32 i) { return snprintf(buf, 64, "%u", u32s[i]); })
+		<< setw(9) << time_it([&](uint32 i) { return format_uint(buf, u32s[i]); })
+		<< setw(9) << time_it([&](uint32 i) { rope.set_cursor(0); rope << u32s[i]; return rope.get_cursor(); })
+		<< endl;
+
+	cout << "int64     " << setw(14) << time_it([&](uint32 i) { return snprintf(buf, 64, "%lld", (long long)i64s[i]); })
+		<< setw(9) << time_it([&](uint32 i) { return format_int(buf, i64s[i]); })
+		<< setw(9) << time_it([&](uint32 i) { rope.set_cursor(0); rope << i64s[i]; return rope.get_cursor(); })
+		<< endl;
+
+	cout << "float .2  " << setw(14) << time_it([&](uint32 i) { return snprintf(buf, 64, "%.2f", floats[i]); })
+		<< setw(9) << time_it([&](uint32 i) { return format_fixed(buf, floats[i], 2); })
+		<< setw(9) << time_it([&](uint32 i) { rope.set_cursor(0); rope << floats[i]; return rope.get_cursor(); })
+		<< endl;
+
+	cout << "float min " << setw(14) << time_it([&](uint32 i) { return snprintf(buf, 64, "%.9g", floats[i]); })
+		<< setw(9) << time_it([&](uint32 i) { return format_shortest(buf, floats[i]); })
+		<< setw(9) << time_it([&](uint32 i) { rope.set_cursor(0); rope.append(floats[i], SHORTEST); return rope.get_cursor(); })
+		<< endl;
+}
@@ -0,0 +1,89 @@
+/*
+ * Throughput of parsing numeric CSV lines.
+ *
+ * A block of lines like "1021,-37.8136276,144.9630576,12.25,880" is parsed
+ * field by field with strtod, with parse_number, and with parse_fields, which
+ * does a whole line in one pass. Throughput is in MB of text per second.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace std;
+using namespace etk;
+
+
+static const uint32 LINES = 20000;
+static const uint32 FIELDS = 5;
+static const uint32 PASSES = 10;
+
+static double values[FIELDS];
+static volatile double sink = 0;
+
+
+template <typename F> double time_it(const string& text, F parse_line)
+{
+	auto start = chrono::steady_clock::now();
+	for(uint32 p = 0; p < PASSES; p++)
+	{
+		const char* line = text.c_str();
+		const char* end = line + text.size();
+		while(line < end)
+		{
+			const char* eol = line;
+			while(*eol != '\n')
+				eol++;
+			parse_line(line, eol);
+			sink = sink + values[1];
+			line = eol + 1;
+		}
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	return text.size() * double(PASSES) / elapsed.count() / 1e6;
+}
+
+
+int main()
+{
+	string text;
+	srand(1);
+	for(uint32 i = 0; i < LINES; i++)
+	{
+		char line[96];
+		snprintf(line, 96, "%u,%.7f,%.7f,%.2f,%d\n", i, -37.0 - rand()/double(RAND_MAX),
+			144.0 + rand()/double(RAND_MAX), rand()/100.0, rand() % 1000);
+		text += line;
+	}
+
+	double a = time_it(text, [](const char* line, const char*) {
+		char* p = (char*)line;
+		for(uint32 f = 0; f < FIELDS; f++)
+		{
+			values[f] = strtod(p, &p);
+			p++;
+		}
+	});
+
+	double b = time_it(text, [](const char* line, const char* eol) {
+		for(uint32 f = 0; f < FIELDS; f++)
+		{
+			ParseResult r = parse_number(line, eol, values[f]);
+			line = r.end + 1;
+		}
+	});
+
+	double c = time_it(text, [](const char* line, const char* eol) {
+		parse_fields(line, eol, ',', values, FIELDS);
+	});
+
+	cout << fixed << setprecision(1);
+	cout << "strtod          " << setw(7) << a << " MB/s" << endl;
+	cout << "parse_number    " << setw(7) << b << " MB/s" << endl;
+	cout << "parse_fields    " << setw(7) << c << " MB/s" << endl;
+}
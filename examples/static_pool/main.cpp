@@ -0,0 +1,78 @@
+/*
+ * Compares calling a pool through the Pool interface with naming the pool
+ * type as a template parameter.
+ *
+ * The same workloads run twice:
+ *
+ *   - through a Pool*, where every call goes through the vtable
+ *   - through the concrete MemPool type, where the calls can be inlined
+ *
+ * Time is printed in nanoseconds per operation.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+
+using namespace std;
+using namespace etk;
+
+
+typedef MemPool<1024*16, 64> PoolType;
+
+static const uint32 ITERATIONS = 2000000;
+static const uint32 LIST_ROUNDS = 50000;
+static const int LIST_ITEMS = 32;
+
+static PoolType pool;
+
+// read through a volatile so the compiler can't see which pool it points to
+static Pool* volatile erased = &pool;
+
+volatile uint32 sink;
+
+
+template <typename P> double alloc_free(P* p)
+{
+	auto start = chrono::steady_clock::now();
+	for(uint32 i = 0; i < ITERATIONS; i++)
+	{
+		void* a = p->alloc(24);
+		void* b = p->alloc(24);
+		p->free(a);
+		p->free(b);
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	return elapsed.count() / (ITERATIONS * 4.0) * 1e9;
+}
+
+
+template <typename P> double list_appends(P* p)
+{
+	auto start = chrono::steady_clock::now();
+	for(uint32 r = 0; r < LIST_ROUNDS; r++)
+	{
+		DynamicList<int, 4, P> list(p);
+		for(int i = 0; i < LIST_ITEMS; i++)
+			list.append(i);
+		sink = list[LIST_ITEMS-1];
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	return elapsed.count() / (LIST_ROUNDS * double(LIST_ITEMS)) * 1e9;
+}
+
+
+int main()
+{
+	double a = alloc_free<Pool>(erased);
+	double b = alloc_free<PoolType>(&pool);
+	double c = list_appends<Pool>(erased);
+	double d = list_appends<PoolType>(&pool);
+
+	cout << "                        Pool*    MemPool   (ns/op)" << endl;
+	cout << fixed << setprecision(2);
+	cout << "alloc / free       " << setw(10) << a << setw(11) << b << endl;
+	cout << "DynamicList append " << setw(10) << c << setw(11) << d << endl;
+}
@@ -0,0 +1,116 @@
+/*
+ * Times building strings out of many small appends.
+ *
+ * StaticString used to find the end of the string each time something was
+ * appended to it, which is what the "rescan" column does with a Rope over
+ * a plain char buffer. StaticString now keeps its length, so an append only
+ * touches the characters being added.
+ *
+ * Two workloads are run: a 20 field NMEA style sentence, and a long log
+ * line built from 500 short fields.
+ */
+
+#include <etk/etk.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+
+using namespace std;
+using namespace etk;
+
+
+static const uint32 REPEATS = 20000;
+
+
+// appends the way StaticString used to, by finding the end of the string first
+template <uint32 L> struct RescanString
+{
+	char buf[L];
+
+	void clear()
+	{
+		buf[0] = '\0';
+	}
+
+	void append(const char* s)
+	{
+		Rope r(buf, L);
+		r.set_cursor(r.length());
+		r += s;
+	}
+
+	void append(int32 i)
+	{
+		Rope r(buf, L);
+		r.set_cursor(r.length());
+		r << i;
+	}
+
+	uint32 length()
+	{
+		Rope r(buf, L);
+		return r.length();
+	}
+};
+
+template <uint32 L> struct CachedString
+{
+	StaticString<L> ss;
+
+	void clear()
+	{
+		ss = "";
+	}
+
+	void append(const char* s)
+	{
+		ss += s;
+	}
+
+	void append(int32 i)
+	{
+		ss += i;
+	}
+
+	uint32 length()
+	{
+		return ss.length();
+	}
+};
+
+
+template <typename S> double time_build(S& s, uint32 fields)
+{
+	volatile uint32 sink = 0;
+	auto start = chrono::steady_clock::now();
+	for(uint32 r = 0; r < REPEATS; r++)
+	{
+		s.clear();
+		s.append("$GPXXX");
+		for(uint32 f = 0; f < fields; f++)
+		{
+			s.append(",");
+			s.append(int32(r+f));
+		}
+		sink = sink + s.length();
+	}
+	chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+	return elapsed.count() / REPEATS;
+}
+
+
+int main()
+{
+	static RescanString<128> short_rescan;
+	static CachedString<128> short_cached;
+	static RescanString<4096> long_rescan;
+	static CachedString<4096> long_cached;
+
+	cout << "fields      rescan       cached   (ns per string)" << endl;
+	cout << fixed << setprecision(0);
+	cout << setw(6) << 20 << setw(12) << time_build(short_rescan, 20)
+		<< setw(13) << time_build(short_cached, 20) << endl;
+	cout << setw(6) << 500 << setw(12) << time_build(long_rescan, 500)
+		<< setw(13) << time_build(long_cached, 500) << endl;
+}
@@ -0,0 +1,244 @@
+/*
+   Copyright (C) 2022 Samuel Cowen samuel.cowen@camelsoftware.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_ARENA_H_INCLUDED
+#define ETK_ARENA_H_INCLUDED
+
+#include <string.h>
+#include "types.h"
+#include "pool.h"
+
+
+namespace etk
+{
+    /**
+     * MonotonicArena is a Pool that allocates by bumping a pointer.
+     *
+     * free() does nothing. Memory is only given back all at once with reset(),
+     * or back to a checkpoint taken with mark() by calling rewind(). This
+     * suits work that builds up temporary objects and then drops all of them,
+     * such as parsing a message or building a reply.
+     *
+     * Each allocation carries a small header holding its size and reference
+     * count so that realloc() can copy it and pool pointers keep working.
+     * realloc() on the most recent allocation grows or shrinks it in place,
+     * so a DynamicList that is being appended to does not leave copies of
+     * itself behind.
+     *
+     * SIZE = number of bytes to reserve for the arena
+     * ALIGN = alignment of every allocation. Must be a power of two, and at
+     * least the alignment of a uint32 so the headers can be read.
+     */
+    template <uint32 SIZE, uint32 ALIGN = 8> class MonotonicArena final : public Pool
+    {
+        public:
+            /**
+             * A checkpoint returned by mark().
+             */
+            typedef uint32 Mark;
+
+            MonotonicArena()
+            {
+                begin();
+            }
+
+            /**
+             * Some systems use startup code designed for C.
+             * In this case, C++ constructors for global objects are not
+             * executed when the program begins. Here we provide an
+             * alternative way to initialise the object.
+             */
+            void begin()
+            {
+                static_assert((ALIGN & (ALIGN-1)) == 0, "ALIGN must be a power of two.");
+                static_assert(ALIGN >= alignof(Head), "ALIGN is too small for the allocation header.");
+                static_assert(SIZE%ALIGN == 0, "The arena size must be a multiple of ALIGN.");
+                reset();
+            }
+
+            void* alloc(uint32 sz)
+            {
+                if(sz > SIZE) {
+                    return nullptr;
+                }
+
+                uint32 n = round_up(sz) + HEAD_SIZE;
+                if(n > SIZE - top) {
+                    return nullptr;
+                }
+
+                Head* head = (Head*)&memory[top];
+                head->size = sz;
+                head->ref = 1;
+
+                last = top;
+                top += n;
+                return (void*)&memory[last + HEAD_SIZE];
+            }
+
+            /**
+             * free does nothing. Use reset() or rewind() to reclaim memory.
+             */
+            void free(void* ptr)
+            {
+                (void)(ptr);
+            }
+
+            /**
+             * realloc resizes the most recent allocation in place. Any other
+             * allocation is copied to the top of the arena if it needs to
+             * grow.
+             */
+            void* realloc(void* ptr, uint32 sz)
+            {
+                if(ptr == nullptr) {
+                    return alloc(sz);
+                }
+
+                uint32 offset = offset_of(ptr);
+                Head* head = (Head*)&memory[offset];
+                if(offset == last)
+                {
+                    if(sz > SIZE - HEAD_SIZE - offset) {
+                        return nullptr;
+                    }
+                    head->size = sz;
+                    top = offset + HEAD_SIZE + round_up(sz);
+                    return ptr;
+                }
+
+                if(sz <= head->size) {
+                    return ptr;
+                }
+
+                void* n = alloc(sz);
+                if(n == nullptr) {
+                    return nullptr;
+                }
+                memcpy(n, ptr, head->size);
+                return n;
+            }
+
+            /**
+             * Nothing is ever freed so there is nothing to join. Returns 0.
+             */
+            uint32 coalesce()
+            {
+                return 0;
+            }
+
+            uint32 ref(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    Head* head = (Head*)&memory[offset_of(ptr)];
+                    head->ref++;
+                    return head->ref;
+                }
+                return 0;
+            }
+
+            /**
+             * Decrements the reference count. The memory is not reclaimed when
+             * it reaches zero.
+             */
+            uint32 unref(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    Head* head = (Head*)&memory[offset_of(ptr)];
+                    if(head->ref > 0) {
+                        head->ref--;
+                    }
+                    return head->ref;
+                }
+                return 0;
+            }
+
+            /**
+             * Releases every allocation at once.
+             */
+            void reset()
+            {
+                top = 0;
+                last = NO_ALLOCATION;
+            }
+
+            /**
+             * Returns a checkpoint that rewind() can return to.
+             */
+            Mark mark() const
+            {
+                return top;
+            }
+
+            /**
+             * Releases everything allocated since the checkpoint was taken.
+             * Checkpoints taken after this one are no longer valid.
+             */
+            void rewind(Mark m)
+            {
+                if(m < top) {
+                    top = m;
+                    last = NO_ALLOCATION;
+                }
+            }
+
+            /**
+             * Returns the number of bytes used, including headers.
+             */
+            uint32 used() const
+            {
+                return top;
+            }
+
+            /**
+             * Returns the number of bytes left.
+             */
+            uint32 available() const
+            {
+                return SIZE - top;
+            }
+
+            void* get_memory() {
+                return &memory[0];
+            }
+
+        private:
+            struct Head
+            {
+                uint32 size;
+                uint32 ref;
+            };
+
+            static const uint32 HEAD_SIZE = (sizeof(Head) + ALIGN - 1) & ~(ALIGN - 1);
+            static const uint32 NO_ALLOCATION = 0xFFFFFFFF;
+
+            static uint32 round_up(uint32 sz)
+            {
+                return (sz + ALIGN - 1) & ~(ALIGN - 1);
+            }
+
+            uint32 offset_of(void* ptr)
+            {
+                return ((uint8*)ptr - &memory[0]) - HEAD_SIZE;
+            }
+
+            uint32 top;
+            uint32 last;
+            alignas(ALIGN) uint8 memory[SIZE];
+    };
+}
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef ETK_CONCURRENT_OBJECT_POOL_H
+#define ETK_CONCURRENT_OBJECT_POOL_H
+
+#ifndef __AVR__
+
+#include <atomic>
+#include <type_traits>
+#include "types.h"
+#include "objpool.h"
+
+namespace etk
+{
+    /*
+    ConcurrentObjectArrayAllocator is a thread safe version of ObjectArrayAllocator.
+
+    Free objects are kept on a lock-free stack (a Treiber stack). The head of the
+    stack is an object index packed together with a generation counter that is
+    bumped on every change, so a thread that was preempted mid-pop cannot be
+    fooled by an object that was popped and pushed back in the meantime (ABA).
+    The free list links are kept apart from the objects so that writing to an
+    allocated object never races with a thread walking the stack.
+
+    alloc() and free() can be called from any thread. Threads that allocate a
+    lot should use a Magazine, which keeps a small private stash of objects and
+    only touches the shared stack to refill or drain it in batches.
+
+    @code
+    etk::ConcurrentObjectArrayAllocator<Message, 256> messages;
+
+    void producer()
+    {
+        etk::ConcurrentObjectArrayAllocator<Message, 256>::Magazine<16> mag(messages);
+        Message* m = mag.alloc();
+        ...
+    }
+    @endcode
+    */
+    template<typename T, uint32 N_OBJECTS> class ConcurrentObjectArrayAllocator : public ObjectAllocator<T>
+    {
+        public:
+            ConcurrentObjectArrayAllocator()
+            {
+                static_assert(N_OBJECTS > 0, "The allocator must hold at least one object.");
+                static_assert(N_OBJECTS < NIL, "Too many objects.");
+
+                for(uint32 i = 0; i < N_OBJECTS - 1; i++)
+                    links[i].store(i + 1, std::memory_order_relaxed);
+                links[N_OBJECTS - 1].store(NIL, std::memory_order_relaxed);
+                head.store(pack(0, 0), std::memory_order_release);
+            }
+
+            T* alloc()
+            {
+                uint32 index = pop();
+                if(index == NIL) {
+                    return nullptr;
+                }
+                return object(index);
+            }
+
+            bool free(T* obj_ptr)
+            {
+                if(!owns(obj_ptr)) {
+                    return false;
+                }
+                uint32 index = index_of(obj_ptr);
+                push_chain(index, index);
+                return true;
+            }
+
+            /**
+             * Returns true if the object came from this allocator.
+             */
+            bool owns(T* obj_ptr) const
+            {
+                const void* ptr = (const void*)obj_ptr;
+                return (ptr >= (const void*)&blocks[0]) && (ptr <= (const void*)&blocks[N_OBJECTS - 1]);
+            }
+
+            /**
+             * Counts the objects on the shared free stack.
+             * Objects held in magazines are not counted. The result is only
+             * exact when no other thread is using the allocator.
+             */
+            int available()
+            {
+                int count = 0;
+                uint32 index = unpack_index(head.load(std::memory_order_acquire));
+                while((index != NIL) && (count < (int)N_OBJECTS))
+                {
+                    count++;
+                    index = links[index].load(std::memory_order_relaxed);
+                }
+                return count;
+            }
+
+            /**
+             * A Magazine is a per-thread cache of objects.
+             *
+             * alloc() and free() on a magazine touch only memory owned by the
+             * calling thread until the magazine runs empty or full. Then half of
+             * CAPACITY objects are moved to or from the shared stack with a
+             * single compare-and-swap.
+             *
+             * A magazine must only be used by one thread. Objects can be freed
+             * to a different magazine (or the allocator) than the one they were
+             * allocated from. Any cached objects are returned when the magazine
+             * is destroyed.
+             */
+            template <uint32 CAPACITY> class Magazine : public ObjectAllocator<T>
+            {
+                public:
+                    Magazine(ConcurrentObjectArrayAllocator& allocator) : allocator(allocator)
+                    {
+                        static_assert(CAPACITY >= 2, "A magazine must hold at least two objects.");
+                    }
+
+                    ~Magazine()
+                    {
+                        flush();
+                    }
+
+                    T* alloc()
+                    {
+                        if(count == 0)
+                        {
+                            count = allocator.pop_batch(cache, CAPACITY/2);
+                            if(count == 0) {
+                                return nullptr;
+                            }
+                        }
+                        count--;
+                        return allocator.object(cache[count]);
+                    }
+
+                    bool free(T* obj_ptr)
+                    {
+                        if(!allocator.owns(obj_ptr)) {
+                            return false;
+                        }
+                        if(count == CAPACITY)
+                        {
+                            allocator.push_batch(&cache[CAPACITY/2], CAPACITY - CAPACITY/2);
+                            count = CAPACITY/2;
+                        }
+                        cache[count++] = allocator.index_of(obj_ptr);
+                        return true;
+                    }
+
+                    /**
+                     * Returns every cached object to the shared stack.
+                     */
+                    void flush()
+                    {
+                        if(count > 0)
+                        {
+                            allocator.push_batch(cache, count);
+                            count = 0;
+                        }
+                    }
+
+                    /**
+                     * The number of objects cached by this magazine.
+                     */
+                    uint32 cached() const
+                    {
+                        return count;
+                    }
+
+                private:
+                    ConcurrentObjectArrayAllocator& allocator;
+                    uint32 cache[CAPACITY];
+                    uint32 count = 0;
+            };
+
+        private:
+            static const uint32 NIL = 0xFFFFFFFF;
+
+            static uint64 pack(uint32 generation, uint32 index)
+            {
+                return (static_cast<uint64>(generation) << 32) | index;
+            }
+
+            static uint32 unpack_index(uint64 h)
+            {
+                return static_cast<uint32>(h);
+            }
+
+            static uint32 unpack_generation(uint64 h)
+            {
+                return static_cast<uint32>(h >> 32);
+            }
+
+            T* object(uint32 index)
+            {
+                return reinterpret_cast<T*>(&blocks[index]);
+            }
+
+            uint32 index_of(T* obj_ptr) const
+            {
+                return reinterpret_cast<const Block*>(obj_ptr) - &blocks[0];
+            }
+
+            uint32 pop()
+            {
+                uint64 h = head.load(std::memory_order_acquire);
+                while(true)
+                {
+                    uint32 index = unpack_index(h);
+                    if(index == NIL) {
+                        return NIL;
+                    }
+                    uint32 next = links[index].load(std::memory_order_relaxed);
+                    if(head.compare_exchange_weak(h, pack(unpack_generation(h) + 1, next),
+                                std::memory_order_acquire, std::memory_order_acquire)) {
+                        return index;
+                    }
+                }
+            }
+
+            /**
+             * Pops up to n objects with one compare-and-swap.
+             * The chain below the head can only change by popping through the
+             * head, which bumps the generation, so if the swap succeeds the
+             * chain that was walked is still intact.
+             */
+            uint32 pop_batch(uint32* out, uint32 n)
+            {
+                uint64 h = head.load(std::memory_order_acquire);
+                while(true)
+                {
+                    uint32 index = unpack_index(h);
+                    uint32 count = 0;
+                    while((index != NIL) && (count < n))
+                    {
+                        out[count++] = index;
+                        index = links[index].load(std::memory_order_relaxed);
+                        if((index != NIL) && (index >= N_OBJECTS)) {
+                            // read a stale link, the head has moved on
+                            break;
+                        }
+                    }
+                    if(count == 0) {
+                        return 0;
+                    }
+                    if((index != NIL) && (index >= N_OBJECTS))
+                    {
+                        h = head.load(std::memory_order_acquire);
+                        continue;
+                    }
+                    if(head.compare_exchange_weak(h, pack(unpack_generation(h) + 1, index),
+                                std::memory_order_acquire, std::memory_order_acquire)) {
+                        return count;
+                    }
+                }
+            }
+
+            /**
+             * Pushes a chain of objects that are already linked from first to last.
+             */
+            void push_chain(uint32 first, uint32 last)
+            {
+                uint64 h = head.load(std::memory_order_relaxed);
+                while(true)
+                {
+                    links[last].store(unpack_index(h), std::memory_order_relaxed);
+                    if(head.compare_exchange_weak(h, pack(unpack_generation(h) + 1, first),
+                                std::memory_order_release, std::memory_order_relaxed)) {
+                        return;
+                    }
+                }
+            }
+
+            void push_batch(const uint32* indices, uint32 n)
+            {
+                for(uint32 i = 0; i + 1 < n; i++)
+                    links[indices[i]].store(indices[i + 1], std::memory_order_relaxed);
+                push_chain(indices[0], indices[n - 1]);
+            }
+
+            typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Block;
+
+            // the stack head is on its own cache line so that threads spinning on it
+            // don't slow down access to the objects
+            alignas(64) std::atomic<uint64> head;
+            alignas(64) std::atomic<uint32> links[N_OBJECTS];
+            Block blocks[N_OBJECTS];
+    };
+}
+
+#endif
+
+#endif // ETK_CONCURRENT_OBJECT_POOL_H
@@ -0,0 +1,552 @@
+#ifndef ETK_CONCURRENT_POOL_H
+#define ETK_CONCURRENT_POOL_H
+
+#ifndef __AVR__
+
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <string.h>
+#include "types.h"
+#include "pool.h"
+
+namespace etk
+{
+    /*
+    ConcurrentMemPool is a thread safe Pool built on a MemPool.
+
+    The MemPool is protected by a mutex, but most allocations never touch it.
+    Small allocations are rounded up to a power of two size class and every
+    thread keeps a private cache of free blocks for each class. A thread claims
+    one of MAX_THREADS cache slots the first time it uses the pool. alloc() and
+    free() on a thread's own blocks only touch its own cache. Caches are refilled
+    from and drained to the MemPool in batches, with one lock per batch.
+
+    A block freed by a thread other than the one that allocated it is pushed on
+    to the owner's remote free queue, a lock-free stack that only the owner
+    empties. Freeing never claims a slot, so a thread that only frees, such as
+    a consumer, doesn't take a cache from the threads that allocate. Every FLUSH_INTERVAL allocations a thread takes back its remote
+    frees and returns anything over half its cache limit to the MemPool, so
+    memory freed by other threads does not get stuck.
+
+    Allocations bigger than the largest size class, and threads that could not
+    claim a slot, use the MemPool directly.
+
+    Reference counts are atomic, so a pool_pointer can be shared between
+    threads. A thread should call release_thread() before it exits to hand its
+    cached blocks back and free its slot.
+
+    @code
+    etk::ConcurrentMemPool<1024*64> pool;
+
+    void worker()
+    {
+        etk::DynamicList<Job> jobs(&pool);
+        ...
+        pool.release_thread();
+    }
+    @endcode
+
+    SIZE = number of bytes to reserve for the backing MemPool
+    CHUNK_SIZE = the chunk size of the backing MemPool
+    MAX_THREADS = the number of threads that can have a cache
+    */
+    template <uint32 SIZE, uint32 CHUNK_SIZE = 64, uint32 MAX_THREADS = 8> class ConcurrentMemPool final : public Pool
+    {
+        public:
+            ConcurrentMemPool() : id(next_id.fetch_add(1, std::memory_order_relaxed))
+            {
+                static_assert(MAX_THREADS < NO_OWNER, "Too many threads.");
+                for(uint32 i = 0; i < MAX_THREADS; i++) {
+                    slots[i].store(std::thread::id(), std::memory_order_relaxed);
+                }
+            }
+
+            ~ConcurrentMemPool() { }
+
+            void* alloc(uint32 sz)
+            {
+                uint32 cls = class_for(sz);
+                if(cls == NO_CLASS) {
+                    return alloc_direct(sz);
+                }
+
+                uint32 slot = my_slot();
+                if(slot == NO_OWNER) {
+                    return alloc_direct(CLASS_MIN << cls);
+                }
+
+                Cache& cache = caches[slot];
+                if(++cache.ops >= FLUSH_INTERVAL) {
+                    maintain(cache);
+                }
+
+                Bin& bin = cache.bins[cls];
+                if(bin.head == nullptr)
+                {
+                    take_remote(cache);
+                    if(bin.head == nullptr) {
+                        refill(bin, cls, slot);
+                        if(bin.head == nullptr) {
+                            return nullptr;
+                        }
+                    }
+                }
+
+                Head* head = bin.head;
+                bin.head = next_of(head);
+                bin.count--;
+                head->ref.store(1, std::memory_order_relaxed);
+                return user_of(head);
+            }
+
+            void free(void* ptr)
+            {
+                if(ptr == nullptr) {
+                    return;
+                }
+
+                Head* head = head_of(ptr);
+                head->ref.store(0, std::memory_order_relaxed);
+                if(head->owner == NO_OWNER) {
+                    free_direct(head);
+                    return;
+                }
+
+                // a thread that hasn't got a slot is treated as a remote thread,
+                // even if it owns a slot that it last looked up in another pool
+                uint32 slot = (tls_pool == id) ? tls_slot : NO_OWNER;
+                if(slot == head->owner) {
+                    put_local(caches[slot], head);
+                }
+                else if(slots[head->owner].load(std::memory_order_acquire) == std::thread::id()) {
+                    // the owning thread has gone, give it straight back
+                    free_direct(head);
+                }
+                else {
+                    push_remote(caches[head->owner], head);
+                }
+            }
+
+            /**
+             * Blocks that are already big enough are returned unchanged.
+             * Otherwise the contents are moved to a new block.
+             */
+            void* realloc(void* ptr, uint32 sz)
+            {
+                if(ptr == nullptr) {
+                    return alloc(sz);
+                }
+
+                Head* head = head_of(ptr);
+                if(sz <= head->size) {
+                    return ptr;
+                }
+
+                void* n = alloc(sz);
+                if(n == nullptr) {
+                    return nullptr;
+                }
+                memcpy(n, ptr, head->size);
+                free(ptr);
+                return n;
+            }
+
+            /**
+             * Coalesces the backing MemPool. Blocks held in thread caches are
+             * not returned first.
+             */
+            uint32 coalesce()
+            {
+                std::lock_guard<std::mutex> lock(backing_lock);
+                return backing.coalesce();
+            }
+
+            uint32 ref(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    return head_of(ptr)->ref.fetch_add(1, std::memory_order_relaxed) + 1;
+                }
+                return 0;
+            }
+
+            uint32 unref(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    Head* head = head_of(ptr);
+                    uint32 r = head->ref.load(std::memory_order_relaxed);
+                    while(r > 0)
+                    {
+                        if(head->ref.compare_exchange_weak(r, r - 1,
+                                    std::memory_order_acq_rel, std::memory_order_relaxed))
+                        {
+                            if(r == 1) {
+                                free(ptr);
+                            }
+                            return r - 1;
+                        }
+                    }
+                }
+                return 0;
+            }
+
+            /**
+             * Takes back blocks freed by other threads and trims the calling
+             * thread's cache. This happens every FLUSH_INTERVAL allocations
+             * anyway.
+             */
+            void flush()
+            {
+                uint32 slot = find_slot();
+                if(slot != NO_OWNER) {
+                    maintain(caches[slot]);
+                }
+            }
+
+            /**
+             * Returns every block cached by the calling thread to the backing
+             * pool and frees its slot for another thread.
+             */
+            void release_thread()
+            {
+                uint32 slot = find_slot();
+                if(slot == NO_OWNER) {
+                    return;
+                }
+
+                Cache& cache = caches[slot];
+                take_remote(cache);
+                for(uint32 cls = 0; cls < N_CLASSES; cls++) {
+                    trim(cache.bins[cls], 0);
+                }
+                cache.ops = 0;
+
+                // close the remote queue so that threads which still think the
+                // slot is in use free straight to the backing pool, then give
+                // back whatever they pushed while the cache was being emptied
+                Head* head = cache.remote.exchange(closed(), std::memory_order_acq_rel);
+                while(head != nullptr)
+                {
+                    Head* next = next_of(head);
+                    free_direct(head);
+                    head = next;
+                }
+
+                slots[slot].store(std::thread::id(), std::memory_order_release);
+                tls_pool = 0;
+            }
+
+            /**
+             * Returns the number of blocks cached by the calling thread.
+             */
+            uint32 cached()
+            {
+                uint32 slot = find_slot();
+                uint32 count = 0;
+                if(slot != NO_OWNER)
+                {
+                    for(uint32 cls = 0; cls < N_CLASSES; cls++) {
+                        count += caches[slot].bins[cls].count;
+                    }
+                }
+                return count;
+            }
+
+#ifndef ETK_NO_POOL_STATS
+            /**
+             * Returns the occupancy counters of the backing MemPool. Blocks
+             * held in thread caches count as used.
+             */
+            PoolStats stats()
+            {
+                std::lock_guard<std::mutex> lock(backing_lock);
+                return backing.stats();
+            }
+#endif
+
+        private:
+            static const uint32 NO_OWNER = 0xFFFF;
+            static const uint32 NO_CLASS = 0xFFFF;
+            static const uint32 CLASS_MIN = 16;
+            static const uint32 N_CLASSES = 6;  // 16 to 512 bytes
+            static const uint32 BIN_LIMIT = 32;
+            static const uint32 REFILL = 8;
+            static const uint32 FLUSH_INTERVAL = 1024;
+
+            struct Head
+            {
+                std::atomic<uint32> ref;
+                uint32 size;    // usable bytes
+                uint16 cls;     // size class, or NO_CLASS
+                uint16 owner;   // cache slot, or NO_OWNER
+            };
+
+            // every block is at least CLASS_MIN bytes, so while a block is free
+            // the link to the next one is kept in the block itself
+            static const uint32 HEAD_SIZE = (sizeof(Head) + 15) & ~15;
+
+            struct Bin
+            {
+                Head* head = nullptr;
+                uint32 count = 0;
+            };
+
+            struct Cache
+            {
+                Bin bins[N_CLASSES];
+                uint32 ops = 0;
+                // blocks freed by other threads
+                alignas(64) std::atomic<Head*> remote{nullptr};
+            };
+
+            static uint32 class_for(uint32 sz)
+            {
+                uint32 cls = 0;
+                uint32 csz = CLASS_MIN;
+                while(csz < sz)
+                {
+                    cls++;
+                    csz <<= 1;
+                    if(cls == N_CLASSES) {
+                        return NO_CLASS;
+                    }
+                }
+                return cls;
+            }
+
+            static Head* head_of(void* ptr)
+            {
+                return (Head*)((uint8*)ptr - HEAD_SIZE);
+            }
+
+            static void* user_of(Head* head)
+            {
+                return (void*)((uint8*)head + HEAD_SIZE);
+            }
+
+            static Head* next_of(Head* head)
+            {
+                return *(Head**)user_of(head);
+            }
+
+            static void set_next(Head* head, Head* next)
+            {
+                *(Head**)user_of(head) = next;
+            }
+
+            // marks the remote queue of a slot that nobody owns. blocks are
+            // aligned, so it can't be mistaken for one.
+            static Head* closed()
+            {
+                return reinterpret_cast<Head*>(uintptr_t(1));
+            }
+
+            /**
+             * Returns the cache slot of the calling thread, or NO_OWNER if it
+             * hasn't got one.
+             */
+            uint32 find_slot()
+            {
+                // pools are matched by id rather than address, in case a new
+                // pool is made where an old one used to be
+                if(tls_pool == id) {
+                    return tls_slot;
+                }
+
+                std::thread::id me = std::this_thread::get_id();
+                for(uint32 i = 0; i < MAX_THREADS; i++)
+                {
+                    if(slots[i].load(std::memory_order_acquire) == me) {
+                        tls_pool = id;
+                        tls_slot = i;
+                        return i;
+                    }
+                }
+                return NO_OWNER;
+            }
+
+            /**
+             * Returns the cache slot of the calling thread, claiming one if it
+             * doesn't have one yet. Returns NO_OWNER if they are all taken.
+             */
+            uint32 my_slot()
+            {
+                uint32 slot = find_slot();
+                if(slot != NO_OWNER) {
+                    return slot;
+                }
+
+                std::thread::id me = std::this_thread::get_id();
+                for(uint32 i = 0; i < MAX_THREADS; i++)
+                {
+                    std::thread::id none;
+                    if(slots[i].compare_exchange_strong(none, me, std::memory_order_acq_rel))
+                    {
+                        // open the remote queue again
+                        caches[i].remote.store(nullptr, std::memory_order_release);
+                        tls_pool = id;
+                        tls_slot = i;
+                        return i;
+                    }
+                }
+                return NO_OWNER;
+            }
+
+            void* alloc_direct(uint32 sz)
+            {
+                Head* head;
+                {
+                    std::lock_guard<std::mutex> lock(backing_lock);
+                    head = (Head*)backing.alloc(sz + HEAD_SIZE);
+                }
+                if(head == nullptr) {
+                    return nullptr;
+                }
+                new(&head->ref) std::atomic<uint32>(1);
+                head->size = sz;
+                head->cls = NO_CLASS;
+                head->owner = NO_OWNER;
+                return user_of(head);
+            }
+
+            void free_direct(Head* head)
+            {
+                std::lock_guard<std::mutex> lock(backing_lock);
+                backing.free(head);
+            }
+
+            /**
+             * Fills an empty bin with REFILL blocks carved from the backing
+             * pool under one lock.
+             */
+            void refill(Bin& bin, uint32 cls, uint32 slot)
+            {
+                void* blocks[REFILL];
+                uint32 n = REFILL;
+                {
+                    std::lock_guard<std::mutex> lock(backing_lock);
+                    while((n > 0) && !backing.alloc_n(blocks, (CLASS_MIN << cls) + HEAD_SIZE, n)) {
+                        n /= 2;
+                    }
+                }
+
+                for(uint32 i = 0; i < n; i++)
+                {
+                    Head* head = (Head*)blocks[i];
+                    new(&head->ref) std::atomic<uint32>(0);
+                    head->size = CLASS_MIN << cls;
+                    head->cls = cls;
+                    head->owner = slot;
+                    set_next(head, bin.head);
+                    bin.head = head;
+                }
+                bin.count += n;
+            }
+
+            /**
+             * Returns blocks from a bin to the backing pool until it holds
+             * keep blocks.
+             */
+            void trim(Bin& bin, uint32 keep)
+            {
+                if(bin.count <= keep) {
+                    return;
+                }
+
+                void* blocks[BIN_LIMIT];
+                uint32 n = 0;
+                while(bin.count > keep)
+                {
+                    blocks[n++] = bin.head;
+                    bin.head = next_of(bin.head);
+                    bin.count--;
+                    if(n == BIN_LIMIT) {
+                        std::lock_guard<std::mutex> lock(backing_lock);
+                        backing.free_n(blocks, n);
+                        n = 0;
+                    }
+                }
+                if(n > 0) {
+                    std::lock_guard<std::mutex> lock(backing_lock);
+                    backing.free_n(blocks, n);
+                }
+            }
+
+            void put_local(Cache& cache, Head* head)
+            {
+                Bin& bin = cache.bins[head->cls];
+                set_next(head, bin.head);
+                bin.head = head;
+                bin.count++;
+                if(bin.count > BIN_LIMIT) {
+                    trim(bin, BIN_LIMIT/2);
+                }
+            }
+
+            void push_remote(Cache& cache, Head* head)
+            {
+                Head* top = cache.remote.load(std::memory_order_relaxed);
+                do {
+                    if(top == closed())
+                    {
+                        // the owner has released its slot
+                        free_direct(head);
+                        return;
+                    }
+                    set_next(head, top);
+                } while(!cache.remote.compare_exchange_weak(top, head,
+                            std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            /**
+             * Moves everything on the remote free queue into the local bins.
+             * The whole queue is taken in one exchange, so there is no ABA.
+             */
+            void take_remote(Cache& cache)
+            {
+                Head* head = cache.remote.exchange(nullptr, std::memory_order_acquire);
+                while(head != nullptr)
+                {
+                    Head* next = next_of(head);
+                    put_local(cache, head);
+                    head = next;
+                }
+            }
+
+            void maintain(Cache& cache)
+            {
+                cache.ops = 0;
+                take_remote(cache);
+                for(uint32 cls = 0; cls < N_CLASSES; cls++) {
+                    trim(cache.bins[cls], BIN_LIMIT/2);
+                }
+            }
+
+            static std::atomic<uint64> next_id;
+            static thread_local uint64 tls_pool;
+            static thread_local uint32 tls_slot;
+
+            const uint64 id;
+            std::atomic<std::thread::id> slots[MAX_THREADS];
+            Cache caches[MAX_THREADS];
+
+            std::mutex backing_lock;
+            MemPool<SIZE, CHUNK_SIZE> backing;
+    };
+
+    template <uint32 SIZE, uint32 CHUNK_SIZE, uint32 MAX_THREADS>
+        std::atomic<uint64> ConcurrentMemPool<SIZE, CHUNK_SIZE, MAX_THREADS>::next_id(1);
+
+    template <uint32 SIZE, uint32 CHUNK_SIZE, uint32 MAX_THREADS>
+        thread_local uint64 ConcurrentMemPool<SIZE, CHUNK_SIZE, MAX_THREADS>::tls_pool = 0;
+
+    template <uint32 SIZE, uint32 CHUNK_SIZE, uint32 MAX_THREADS>
+        thread_local uint32 ConcurrentMemPool<SIZE, CHUNK_SIZE, MAX_THREADS>::tls_slot = 0;
+}
+
+#endif
+
+#endif // ETK_CONCURRENT_POOL_H
@@ -27,11 +27,75 @@ inline void *operator new(size_t, void *buf) {
 #include "pool.h"
 #include "types.h"
 #include "math_util.h"
+#include "relocate.h"
 
 
 namespace etk
 {
 
+    /**
+     * \brief Grows and shrinks a DynamicList by a fixed number of items.
+     *
+     * Memory use stays tight, but appending n items costs n/STEP reallocs. 
+     * The list only shrinks once it has two steps spare, so a pop straight 
+     * after an append does not realloc.
+     */
+    template <uint32 STEP> struct LinearGrowth
+    {
+        static_assert(STEP > 0, "STEP must be at least one.");
+
+        /**
+         * Returns the capacity to grow to so that at least needed items fit.
+         */
+        static uint32 grow(uint32 reserved, uint32 needed)
+        {
+            while(reserved < needed) {
+                reserved += STEP;
+            }
+            return reserved;
+        }
+
+        /**
+         * Returns the capacity to shrink to, or reserved to leave it alone.
+         */
+        static uint32 shrink(uint32 reserved, uint32 size)
+        {
+            if(reserved >= size + STEP*2) {
+                return reserved - STEP;
+            }
+            return reserved;
+        }
+    };
+
+    /**
+     * \brief Doubles the capacity of a DynamicList when it is full.
+     *
+     * Appends are amortised O(1). The capacity is halved once the list is 
+     * down to a quarter full, so memory is returned without reallocating 
+     * back and forth around the boundary. It never shrinks below MIN.
+     */
+    template <uint32 MIN = 4> struct GeometricGrowth
+    {
+        static_assert(MIN > 0, "MIN must be at least one.");
+
+        static uint32 grow(uint32 reserved, uint32 needed)
+        {
+            reserved = max(reserved, MIN);
+            while(reserved < needed) {
+                reserved *= 2;
+            }
+            return reserved;
+        }
+
+        static uint32 shrink(uint32 reserved, uint32 size)
+        {
+            if((reserved > MIN) && (size <= reserved/4)) {
+                return max(reserved/2, MIN);
+            }
+            return reserved;
+        }
+    };
+
     /**
      * \class DynamicList
      *
@@ -42,14 +106,26 @@ namespace etk
      * increase the number of objects it can hold by RESIZE_STEP. 
      * e.g. RESIZE_STEP = 4. If size() == 12 and append is called, it will resize to hold 
      * 16 objects. 
+     *
+     * A different GROWTH policy can be given instead. GeometricGrowth doubles
+     * the capacity, which makes appending amortised O(1) at the cost of 
+     * memory. reserve() and shrink_to_fit() set the capacity directly.
+     *
+     * Items are constructed in place and moved rather than copied where 
+     * possible. Trivially relocatable items are resized with Pool::realloc,
+     * anything else is moved to a new allocation one item at a time.
      * @tparam T The type of object that the list contains.
+     * @tparam POOL The type of memory pool. Use a concrete pool such as 
+     * MemPool<4096> to let the compiler inline pool calls.
+     * @tparam GROWTH How the capacity changes as items are added and removed.
      */
 
 
-    template <typename T, uint32 RESIZE_STEP = 1> class DynamicList
+    template <typename T, uint32 RESIZE_STEP = 1, typename POOL = Pool, 
+             typename GROWTH = LinearGrowth<RESIZE_STEP>> class DynamicList
     {
         public:
-            DynamicList(Pool* _pool) 
+            DynamicList(POOL* _pool) 
             {
                 pool = _pool;
                 //space = pool->alloc(sizeof(T)*2);
@@ -69,56 +145,56 @@ namespace etk
                 }
             }
 
-            DynamicList(DynamicList& list)
+            DynamicList(const DynamicList& list)
             {
                 pool = list.pool;
-                void* tmp_space = space;
-                space = pool->realloc(space, sizeof(T)*list.reserved);
-                if(space == nullptr)
-                {
-                    space = tmp_space;
-                    return;
-                }
-                reserved = list.reserved;
-
-                memcpy(space, list.space, sizeof(T)*list.reserved);
-                list_end = list.list_end;
+                space = nullptr;
+                reserved = 0;
+                list_end = -1;
+                copy_from(list);
             }
 
-            DynamicList(const DynamicList& list)
+            DynamicList(DynamicList&& list)
             {
                 pool = list.pool;
-                void* tmp_space = space;
-                space = pool->realloc(space, sizeof(T)*list.reserved);
-                if(space == nullptr)
-                {
-                    space = tmp_space;
-                    return;
-                }
+                space = list.space;
                 reserved = list.reserved;
-
-                memcpy(space, list.space, sizeof(T)*list.reserved);
                 list_end = list.list_end;
+
+                list.space = nullptr;
+                list.reserved = 0;
+                list.list_end = -1;
             }
 
             // assignment operator
             DynamicList& operator = (const DynamicList& sp)
             {
                 // if not assigning to self
-                if (space != sp.space)
+                if (this != &sp)
                 {
-                    pool = sp.pool;
-                    void* tmp_space = space;
-                    space = pool->realloc(space, sizeof(T)*sp.reserved);
-                    if(space == nullptr)
-                    {
-                        space = tmp_space;
-                        return *this;
+                    clear();
+                    copy_from(sp);
+                }
+                return *this;
+            }
+
+            DynamicList& operator = (DynamicList&& sp)
+            {
+                if (this != &sp)
+                {
+                    clear();
+                    if(space != nullptr) {
+                        pool->free(space);
                     }
-                    reserved = sp.reserved;
 
-                    memcpy(space, sp.space, sizeof(T)*sp.reserved);
+                    pool = sp.pool;
+                    space = sp.space;
+                    reserved = sp.reserved;
                     list_end = sp.list_end;
+
+                    sp.space = nullptr;
+                    sp.reserved = 0;
+                    sp.list_end = -1;
                 }
                 return *this;
             }
@@ -206,21 +282,30 @@ namespace etk
              * \brief Adds an item to the end of the list and increments the size of the list by 1.
              * \Returns true on success or false if it has failed to allocate more memory.
              */
-            bool append(T& t)
+            bool append(const T& t)
             {
-                list_end++;
-                if(resize() == false) 
-                {
-                    list_end--;
+                return emplace_back(t);
+            }
+
+            bool append(T&& t)
+            {
+                return emplace_back(static_cast<T&&>(t));
+            }
+
+            /**
+             * \brief Constructs an item at the end of the list from the given arguments.
+             * \Returns true on success or false if it has failed to allocate more memory.
+             */
+            template <typename... U> bool emplace_back(U&&... u)
+            {
+                if(resize(size()+1) == false) {
                     return false;
                 }
-                else 
-                {
-                    T* pt = (T*)space;
-                    pt += list_end;
-                    new(pt)T(t);
-                    return true;
-                }
+
+                list_end++;
+                T* pt = (T*)space;
+                new(&pt[list_end]) T(static_cast<U&&>(u)...);
+                return true;
             }
 
             /**
@@ -228,22 +313,31 @@ namespace etk
              * @arg T the item to be inserted.
              * @arg pos where the item will be inserted. If pos is zero, then it will be inserted at the start of the list. If it's 1, it will become the second item in the list.
              */
-            bool insert(T& t, uint32 pos)
+            bool insert(const T& t, uint32 pos)
+            {
+                return emplace(pos, t);
+            }
+
+            bool insert(T&& t, uint32 pos)
+            {
+                return emplace(pos, static_cast<T&&>(t));
+            }
+
+            /**
+             * \brief Constructs an item in the list at pos from the given arguments.
+             */
+            template <typename... U> bool emplace(uint32 pos, U&&... u)
             {
                 if(pos <= size())
                 {
-                    list_end++;
-                    if(resize() == false) {
-                        list_end--;
+                    if(resize(size()+1) == false) {
                         return false;
                     }
 
                     T* pt = (T*)space;
-                    for(uint32 i = size(); i >= (pos+1); i--)
-                        pt[i] = pt[i-1];
-
-                    new(&pt[pos])T(t);
+                    relocate(&pt[pos+1], &pt[pos], size()-pos);
                     list_end++;
+                    new(&pt[pos]) T(static_cast<U&&>(u)...);
 
                     return true;
                 }
@@ -253,28 +347,34 @@ namespace etk
             /**
              * \brief Removes an item from the list.
              * @arg pos The position of the item to remove.
-             * @arg padding A value / default object to fill in the space at the end of the list.
              */
             void remove(uint32 pos)
             {
-                T* pt = (T*)space;
-                (&pt[pos])->~T();
-                for(uint32 i = pos; i < size()-1; i++)
-                    pt[i] = pt[i+1];
-                list_end--;
+                if(pos < size())
+                {
+                    T* pt = (T*)space;
+                    (&pt[pos])->~T();
+                    relocate(&pt[pos], &pt[pos+1], size()-pos-1);
+                    list_end--;
 
-                resize();
+                    resize(size());
+                }
             }
 
 
-            void remove_item(T& item)
+            void remove_item(const T& item)
             {
-                for(uint32 i = 0; i < size(); i++)
+                T* pt = (T*)space;
+                for(uint32 i = 0; i < size(); )
                 {
-                    T* pt = (T*)space;
-                    if(*pt[i] == item)
+                    if(pt[i] == item)
                     {
                         remove(i);
+                        pt = (T*)space;
+                    }
+                    else
+                    {
+                        i++;
                     }
                 }
             }
@@ -304,7 +404,7 @@ namespace etk
                 }
 
                 list_end = -1;
-                resize();
+                resize(size());
             }
 
             /**
@@ -312,7 +412,7 @@ namespace etk
              * @arg t The item to count.
              * @return The number of these items in the list.
              */
-            uint32 count(T& t)
+            uint32 count(const T& t)
             {
                 uint32 c = 0;
                 T* pt = (T*)space;
@@ -331,7 +431,7 @@ namespace etk
              * @arg end The end position.
              * @arg f The item to fill with.
              */
-            void fill(uint32 start, uint32 end, T& f)
+            void fill(uint32 start, uint32 end, const T& f)
             {
                 T* pt = (T*)space;
                 end = min(end, size());
@@ -347,12 +447,12 @@ namespace etk
             T pop_back()
             {
                 T* pt = (T*)space;
-                if(list_end > 0)
+                if(list_end >= 0)
                 {
-                    T ret = pt[list_end];
+                    T ret(static_cast<T&&>(pt[list_end]));
                     (&pt[list_end])->~T();
                     list_end--;
-                    resize();
+                    resize(size());
                     return ret;
                 }
                 return T();
@@ -361,11 +461,16 @@ namespace etk
             /**
              * \brief Same as append();
              */
-            void push_back(T& t)
+            void push_back(const T& t)
             {
                 append(t);
             }
 
+            void push_back(T&& t)
+            {
+                append(static_cast<T&&>(t));
+            }
+
             /**
              * \brief This operator allows you to access elements of the list just like a normal array.
              */
@@ -393,6 +498,35 @@ namespace etk
                 return list_end+1;
             }
 
+            /**
+             * \brief Returns the number of items the list can hold without
+             * reallocating.
+             */
+            uint32 capacity()
+            {
+                return reserved;
+            }
+
+            /**
+             * \brief Makes room for at least n items.
+             * \Returns false if the memory could not be allocated.
+             */
+            bool reserve(uint32 n)
+            {
+                if(n <= (uint32)reserved) {
+                    return true;
+                }
+                return set_capacity(n);
+            }
+
+            /**
+             * \brief Shrinks the capacity down to the number of items in the list.
+             */
+            void shrink_to_fit()
+            {
+                set_capacity(size());
+            }
+
             /**
              * \brief Returns a const pointer to the array.
              */
@@ -416,38 +550,73 @@ namespace etk
             }
         private:
 
-            bool resize() 
+            /**
+             * Fits the capacity to needed items. Only the items already in 
+             * the list are moved if the memory changes.
+             */
+            bool resize(uint32 needed) 
             {
-                if(reserved <= list_end) 
+                if((uint32)reserved < needed) 
                 {
-                    void* tmp_space = space;
-                    reserved += RESIZE_STEP;
+                    return set_capacity(GROWTH::grow(reserved, needed));
+                }
 
-                    print_pool_ptr();
-                    space = pool->realloc(space, sizeof(T)*reserved);
-                    if(space == nullptr) 
-                    {
-                        space = tmp_space;
-                        reserved -= RESIZE_STEP;
-                        return false;
+                uint32 cap = GROWTH::shrink(reserved, needed);
+                if(cap < (uint32)reserved) {
+                    // if shrinking fails the list just keeps the bigger block
+                    set_capacity(cap);
+                }
+                return true;
+            }
+
+            bool set_capacity(uint32 cap)
+            {
+                if(cap == 0)
+                {
+                    if(space != nullptr) {
+                        pool->free(space);
                     }
+                    space = nullptr;
+                    reserved = 0;
                     return true;
                 }
-                else if(reserved > (list_end+RESIZE_STEP))
+
+                void* n;
+                if(is_trivially_relocatable<T>::value || (space == nullptr))
                 {
-                    if(reserved > RESIZE_STEP) {
-                        reserved -= RESIZE_STEP;
-                        space = pool->realloc(space, sizeof(T)*reserved);
+                    n = pool->realloc(space, sizeof(T)*cap);
+                    if(n == nullptr) {
+                        return false;
                     }
-                    return true;
                 }
                 else
                 {
-                    return true;
+                    // the pool would copy the bytes, so move the items over
+                    // one by one instead
+                    n = pool->alloc(sizeof(T)*cap);
+                    if(n == nullptr) {
+                        return false;
+                    }
+                    relocate((T*)n, (T*)space, size());
+                    pool->free(space);
+                }
+                space = n;
+                reserved = cap;
+                return true;
+            }
+
+            void copy_from(const DynamicList& list)
+            {
+                if(!reserve(list.list_end+1)) {
+                    return;
+                }
+                const T* src = list.buffer();
+                for(int32 i = 0; i <= list.list_end; i++) {
+                    append(src[i]);
                 }
             }
 
-            Pool* pool;
+            POOL* pool;
             void* space;
             int32 reserved = 0;
             int32 list_end = 0;
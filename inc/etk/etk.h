@@ -34,8 +34,11 @@
 
 #include "math_util.h"
 #include "stream.h"
+#include "format.h"
+#include "parse.h"
 #include "rope.h"
 #include "tokeniser.h"
+#include "field_splitter.h"
 #include "matrix.h"
 #include "quaternion.h"
 #include "vector.h"
@@ -44,6 +47,8 @@
 #include "list.h"
 #include "staticstring.h"
 #include "ring_buffer.h"
+#include "spsc_ring_buffer.h"
+#include "mpmc_queue.h"
 #include "time.h"
 #include "filters.h"
 #include "navigation.h"
@@ -52,12 +57,17 @@
 #include "fuzzy.h"
 #include "array.h"
 #include "objpool.h"
+#include "concurrent_objpool.h"
+#include "concurrent_pool.h"
 #include "smrt_ptr.h"
 #include "pool.h"
+#include "tlsf_pool.h"
+#include "arena.h"
 #include "pool_ptr.h"
 #include "dynamic_list.h"
 #include "forward_list.h"
 #include "linked_list.h"
+#include "intrusive_list.h"
 #include "sigslot.h"
 #include "state_machine.h"
 
@@ -0,0 +1,430 @@
+/*
+   Embedded Tool Kit
+   Copyright (C) 2015 Samuel Cowen
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_FIELD_SPLITTER_H_INCLUDED
+#define ETK_FIELD_SPLITTER_H_INCLUDED
+
+#include "types.h"
+#include "math_util.h"
+#include "array.h"
+#include "parse.h"
+
+
+namespace etk
+{
+
+    /**
+     * \brief A set of characters, kept as a 256 bit table so that checking a
+     * character is one lookup.
+     */
+    class DelimiterSet
+    {
+        public:
+            DelimiterSet()
+            {
+                for(uint32 i = 0; i < 8; i++)
+                    bits[i] = 0;
+            }
+
+            /**
+             * \brief Makes a set of every character in the C-string s.
+             */
+            DelimiterSet(const char* s) : DelimiterSet()
+            {
+                while(*s != '\0')
+                    add(*s++);
+            }
+
+            void add(char c)
+            {
+                uint8 u = static_cast<uint8>(c);
+                bits[u >> 5] |= (uint32(1) << (u & 31));
+            }
+
+            void remove(char c)
+            {
+                uint8 u = static_cast<uint8>(c);
+                bits[u >> 5] &= ~(uint32(1) << (u & 31));
+            }
+
+            bool contains(char c) const
+            {
+                uint8 u = static_cast<uint8>(c);
+                return (bits[u >> 5] >> (u & 31)) & 1;
+            }
+
+        private:
+            uint32 bits[8];
+    };
+
+
+    /**
+     * \class Fields
+     *
+     * \brief The fields of a record that FieldSplitter has split.
+     *
+     * Nothing is copied. The fields are found through the offsets that the
+     * splitter wrote to the index, so the record and the index have to stay
+     * put while the Fields are in use. Getting a field is O(1).
+     */
+    template <uint32 N> class Fields
+    {
+        public:
+            Fields(const char* record, const Array<uint16, N>& index, uint32 count, char quote) :
+                record(record), index(&index), count(count), quote(quote)
+            {
+            }
+
+            /**
+             * \brief Returns the number of fields.
+             */
+            uint32 size() const
+            {
+                return count;
+            }
+
+            /**
+             * \brief True if the record had more fields than the index could
+             * hold. The extra fields are left out.
+             */
+            bool truncated() const
+            {
+                return was_truncated;
+            }
+
+            /**
+             * \brief True if the record ended in an NMEA style *XX checksum.
+             */
+            bool has_checksum() const
+            {
+                return checksum_found;
+            }
+
+            /**
+             * \brief True if the record has a checksum and it matches the
+             * exclusive or of everything between the '$' and the '*'.
+             */
+            bool checksum_valid() const
+            {
+                return checksum_found && (checksum == calculated);
+            }
+
+            /**
+             * \brief Returns a pointer to field i and sets len to its length.
+             * Surrounding quotes are left out, but doubled quotes inside them
+             * are not undone; use copy() for that. Returns nullptr if there's
+             * no field i.
+             */
+            const char* get(uint32 i, uint32& len) const
+            {
+                if(i >= count)
+                {
+                    len = 0;
+                    return nullptr;
+                }
+                uint32 start = (*index)[i];
+                uint32 end = (*index)[i+1] - 1;
+                if((quote != '\0') && (end - start >= 2) && (record[start] == quote) && (record[end-1] == quote))
+                {
+                    start++;
+                    end--;
+                }
+                len = end - start;
+                return &record[start];
+            }
+
+            /**
+             * \brief Copies field i to out and null terminates it, turning
+             * doubled quotes in to single ones. Returns false if there's no
+             * field i or it doesn't fit in len characters.
+             */
+            template <typename Tt> bool copy(uint32 i, Tt& out, const uint32 len) const
+            {
+                uint32 n;
+                const char* f = get(i, n);
+                if((f == nullptr) || (len == 0))
+                    return false;
+
+                uint32 o = 0;
+                for(uint32 j = 0; j < n; j++)
+                {
+                    if(o+1 >= len)
+                    {
+                        out[o] = '\0';
+                        return false;
+                    }
+                    out[o++] = f[j];
+                    if((f[j] == quote) && (j+1 < n) && (f[j+1] == quote))
+                        j++;
+                }
+                out[o] = '\0';
+                return true;
+            }
+
+            /**
+             * \brief Parses field i as a number with parse_number. The whole
+             * field must be the number, or the error is NO_NUMBER.
+             */
+            template <typename T> ParseResult parse(uint32 i, T& value) const
+            {
+                uint32 n;
+                const char* f = get(i, n);
+                ParseResult r;
+                if(f == nullptr)
+                {
+                    r.end = record;
+                    r.error = ParseResult::NO_NUMBER;
+                    return r;
+                }
+                r = parse_number(f, f+n, value);
+                if((r.error != ParseResult::NO_NUMBER) && (r.end != f+n))
+                {
+                    r.end = f;
+                    r.error = ParseResult::NO_NUMBER;
+                }
+                return r;
+            }
+
+            /**
+             * \brief Compares field i to a C-string.
+             */
+            bool compare(uint32 i, const char* s) const
+            {
+                uint32 n;
+                const char* f = get(i, n);
+                if(f == nullptr)
+                    return false;
+                for(uint32 j = 0; j < n; j++)
+                {
+                    if(f[j] != s[j])
+                        return false;
+                }
+                return s[n] == '\0';
+            }
+
+        private:
+            friend class FieldSplitter;
+
+            const char* record;
+            const Array<uint16, N>* index;
+            uint32 count;
+            char quote;
+            bool was_truncated = false;
+            bool checksum_found = false;
+            uint8 checksum = 0;
+            uint8 calculated = 0;
+    };
+
+
+    /**
+     * \class FieldSplitter
+     *
+     * \brief Splits a whole record in to fields in one pass.
+     *
+     * Unlike Tokeniser, any number of characters can separate fields, fields
+     * can be quoted so that they may contain separators, and nothing is
+     * copied. The splitter writes where each field starts in to an
+     * Array<uint16, N> that you provide, and the Fields it returns look them
+     * up from there.
+     *
+     * A record ends at len characters, a null character, or a line break
+     * outside quotes. In NMEA mode it also ends at a '*', and the two hex
+     * digits after it are checked against the record.
+     *
+     * An index of N offsets holds up to N-1 fields, and records can be up to
+     * 65534 characters long.
+     *
+     * @code
+     const char* line = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+
+     etk::FieldSplitter splitter(",");
+     splitter.set_nmea(true);
+
+     etk::Array<uint16, 24> index;
+     auto fields = splitter.split(line, strlen(line), index);
+     float altitude;
+     if(fields.checksum_valid() && fields.compare(0, "$GPGGA"))
+         fields.parse(9, altitude);
+     @endcode
+     */
+    class FieldSplitter
+    {
+        public:
+            /**
+             * \brief Each character of delimiters separates fields.
+             */
+            FieldSplitter(const char* delimiters) : delimiters(delimiters)
+            {
+                build();
+            }
+
+            FieldSplitter(const DelimiterSet& delimiters) : delimiters(delimiters)
+            {
+                build();
+            }
+
+            /**
+             * \brief Sets the quote character. The default is '"'. A quote
+             * only counts at the start of a field, and a doubled quote inside
+             * a quoted field stands for one quote. '\0' turns quoting off.
+             */
+            void set_quote(char q)
+            {
+                quote = q;
+                build();
+            }
+
+            /**
+             * \brief In NMEA mode a '*' ends the record and is followed by a
+             * checksum.
+             */
+            void set_nmea(bool on)
+            {
+                nmea = on;
+                build();
+            }
+
+            template <uint32 N> Fields<N> split(const char* record, uint32 len, Array<uint16, N>& index) const
+            {
+                static_assert(N >= 2, "The index needs room for at least one field and the end.");
+                const uint32 max_fields = N-1;
+
+                Fields<N> fields(record, index, 0, quote);
+                if(len > 0xFFFE)
+                    len = 0xFFFE;
+                if((len == 0) || (record[0] == '\0'))
+                    return fields;
+
+                uint32 i = 0;
+                uint8 sum = 0;
+                if(nmea && ((record[0] == '$') || (record[0] == '!')))
+                    i = 1;
+
+                uint32 count = 1;
+                index[0] = 0;
+                bool full = false;
+                uint32 field_start = 0;
+                while(i < len)
+                {
+                    char c = record[i];
+
+                    // most characters aren't special, so get past them quickly
+                    if(!special.contains(c))
+                    {
+                        sum ^= static_cast<uint8>(c);
+                        i++;
+                        continue;
+                    }
+
+                    if((c == quote) && (i == field_start))
+                    {
+                        // find the closing quote, skipping doubled ones
+                        sum ^= static_cast<uint8>(c);
+                        i++;
+                        while((i < len) && (record[i] != '\0'))
+                        {
+                            sum ^= static_cast<uint8>(record[i]);
+                            if(record[i] == quote)
+                            {
+                                if((i+1 < len) && (record[i+1] == quote))
+                                {
+                                    sum ^= static_cast<uint8>(record[i+1]);
+                                    i += 2;
+                                    continue;
+                                }
+                                i++;
+                                break;
+                            }
+                            i++;
+                        }
+                        continue;
+                    }
+
+                    if(delimiters.contains(c))
+                    {
+                        sum ^= static_cast<uint8>(c);
+                        if(!full)
+                        {
+                            if(count < max_fields)
+                                index[count++] = static_cast<uint16>(i+1);
+                            else
+                            {
+                                // no room for more, so the last field ends here
+                                index[count] = static_cast<uint16>(i+1);
+                                full = true;
+                                fields.was_truncated = true;
+                            }
+                        }
+                        i++;
+                        field_start = i;
+                        continue;
+                    }
+
+                    if(nmea && (c == '*'))
+                    {
+                        uint32 value = 0;
+                        uint32 digits = 0;
+                        for(uint32 j = i+1; (j < len) && (digits < 2); j++, digits++)
+                        {
+                            char h = to_upper(record[j]);
+                            if(is_numeric(h))
+                                value = value*16 + (h - '0');
+                            else if((h >= 'A') && (h <= 'F'))
+                                value = value*16 + (h - 'A' + 10);
+                            else
+                                break;
+                        }
+                        fields.checksum_found = (digits == 2);
+                        fields.checksum = static_cast<uint8>(value);
+                        break;
+                    }
+
+                    // the end of the record, or a quote in the middle of a field
+                    if((c == '\0') || (c == '\r') || (c == '\n'))
+                        break;
+                    sum ^= static_cast<uint8>(c);
+                    i++;
+                }
+
+                if(!full)
+                    index[count] = static_cast<uint16>(i+1);
+                fields.count = count;
+                fields.calculated = sum;
+                return fields;
+            }
+
+        private:
+            // everything the inner loop has to stop for
+            void build()
+            {
+                special = delimiters;
+                special.add('\0');
+                special.add('\r');
+                special.add('\n');
+                if(quote != '\0')
+                    special.add(quote);
+                if(nmea)
+                    special.add('*');
+            }
+
+            DelimiterSet delimiters;
+            DelimiterSet special;
+            char quote = '"';
+            bool nmea = false;
+    };
+
+}
+
+#endif
@@ -0,0 +1,382 @@
+/*
+   Embedded Tool Kit
+   Copyright (C) 2015 Samuel Cowen
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_FORMAT_H_INCLUDED
+#define ETK_FORMAT_H_INCLUDED
+
+#include "types.h"
+#include "math_util.h"
+
+
+/*
+ * Number formatting used by Rope and StaticString.
+ *
+ * Each function writes the characters for a number to out and returns how
+ * many it wrote. Nothing is null terminated, and out must have room for
+ * FORMAT_BUFFER_SIZE characters.
+ *
+ * Integers are written two digits at a time from a table of digit pairs, so
+ * there's half as many divisions, and the length is worked out up front so
+ * they can be written straight to their place. Floats are scaled by a power
+ * of ten from a table and rounded to an integer, which doesn't need pow() or
+ * roundf().
+ */
+
+namespace etk
+{
+
+    /**
+     * \brief The most characters any of the format functions will write.
+     */
+    const uint32 FORMAT_BUFFER_SIZE = 40;
+
+    /**
+     * \brief Pass this as the precision to get the fewest digits that read back
+     * as exactly the same float.
+     */
+    const uint8 SHORTEST = 0xFF;
+
+
+    inline const char* digit_pairs()
+    {
+        static const char pairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+        return pairs;
+    }
+
+    inline const uint64* powers_of_ten()
+    {
+        static const uint64 p[20] = {
+            1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+            10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+            100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+            100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+            100000000000000000ULL, 1000000000000000000ULL,
+            10000000000000000000ULL
+        };
+        return p;
+    }
+
+    /**
+     * \brief Returns the number of decimal digits in v. Zero has one digit.
+     *
+     * The bit length of v times log10(2) is either right or one too many, so
+     * one comparison against a power of ten finishes it off.
+     */
+    inline uint32 count_digits(uint64 v)
+    {
+        v |= 1;
+        uint32 bits = 64 - __builtin_clzll(v);
+        uint32 t = (bits*1233) >> 12;
+        return t + 1 - (v < powers_of_ten()[t]);
+    }
+
+    // writes v backwards, ending just before end
+    template <typename U> void write_digits(char* end, U v)
+    {
+        const char* pairs = digit_pairs();
+        while(v >= 100)
+        {
+            uint32 i = static_cast<uint32>(v % 100)*2;
+            v /= 100;
+            *--end = pairs[i+1];
+            *--end = pairs[i];
+        }
+        if(v >= 10)
+        {
+            uint32 i = static_cast<uint32>(v)*2;
+            *--end = pairs[i+1];
+            *--end = pairs[i];
+        }
+        else
+            *--end = static_cast<char>('0'+v);
+    }
+
+    template <typename U> uint32 format_unsigned(char* out, U v, uint32 npad)
+    {
+        if(npad > 20)
+            npad = 20;
+        uint32 digits = count_digits(v);
+        uint32 zeros = (npad > digits) ? npad - digits : 0;
+        for(uint32 i = 0; i < zeros; i++)
+            out[i] = '0';
+        write_digits(out+zeros+digits, v);
+        return zeros+digits;
+    }
+
+    /**
+     * \brief Writes an unsigned integer, with leading zeros to make it at
+     * least npad digits long.
+     */
+    inline uint32 format_uint(char* out, uint32 v, uint32 npad = 1)
+    {
+        return format_unsigned(out, v, npad);
+    }
+
+    inline uint32 format_uint(char* out, uint64 v, uint32 npad = 1)
+    {
+        return format_unsigned(out, v, npad);
+    }
+
+    /**
+     * \brief Writes a signed integer. The padding doesn't count the sign.
+     */
+    inline uint32 format_int(char* out, int32 v, uint32 npad = 1)
+    {
+        if(v < 0)
+        {
+            // negating as unsigned is fine for the smallest int32 too
+            *out = '-';
+            return 1 + format_unsigned(out+1, uint32(0) - static_cast<uint32>(v), npad);
+        }
+        return format_unsigned(out, static_cast<uint32>(v), npad);
+    }
+
+    inline uint32 format_int(char* out, int64 v, uint32 npad = 1)
+    {
+        if(v < 0)
+        {
+            *out = '-';
+            return 1 + format_unsigned(out+1, uint64(0) - static_cast<uint64>(v), npad);
+        }
+        return format_unsigned(out, static_cast<uint64>(v), npad);
+    }
+
+    /**
+     * \brief Writes v with precision digits after the decimal point.
+     *
+     * The arithmetic is done in the type of v, so floats don't need double
+     * support. Precision can't be more than 15. A number too large to scale
+     * in to an int64 is written as 'ovr'.
+     */
+    template <typename F> uint32 format_fixed(char* out, F v, uint8 precision)
+    {
+        char* p = out;
+        if(v != v)
+        {
+            *p++ = 'n'; *p++ = 'a'; *p++ = 'n';
+            return 3;
+        }
+
+        precision &= 0x0F;
+        bool negative = (v < 0);
+        if(negative)
+            v = -v;
+
+        const uint64* pow10 = powers_of_ten();
+        F scaled = v*static_cast<F>(pow10[precision]);
+        if(scaled >= static_cast<F>(9223372036854775807LL))
+        {
+            // also catches infinity
+            if(scaled - scaled != 0)
+            {
+                *p++ = 'i'; *p++ = 'n'; *p++ = 'f';
+            }
+            else
+            {
+                *p++ = 'o'; *p++ = 'v'; *p++ = 'r';
+            }
+            return 3;
+        }
+
+        uint64 t = static_cast<uint64>(scaled);
+        if(scaled - static_cast<F>(t) >= static_cast<F>(0.5))
+            t++;
+
+        if(negative && (t != 0))
+            *p++ = '-';
+        p += format_uint(p, t/pow10[precision]);
+        *p++ = '.';
+        if(precision > 0)
+            p += format_uint(p, t%pow10[precision], precision);
+        return p-out;
+    }
+
+    // 10^k as a double. Up to 10^22 is exact, beyond that it's close enough
+    // for format_shortest to compare against.
+    inline double ten_to(int32 k)
+    {
+        static const double exact[23] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        if(k < 0)
+            return 1.0/ten_to(-k);
+        double r = 1.0;
+        while(k > 22)
+        {
+            r *= 1e22;
+            k -= 22;
+        }
+        return r*exact[k];
+    }
+
+    /**
+     * \brief Writes the fewest significant digits that read back as exactly
+     * the same float.
+     *
+     * Numbers from 0.00001 up to a billion are written out in full, and
+     * anything else gets an exponent, like 1.5e-7.
+     */
+    inline uint32 format_shortest(char* out, float v)
+    {
+        char* p = out;
+        if(is_nan(v))
+        {
+            *p++ = 'n'; *p++ = 'a'; *p++ = 'n';
+            return 3;
+        }
+
+        u32b bits;
+        bits.f = v;
+        if(bits.u & 0x80000000)
+        {
+            *p++ = '-';
+            bits.u &= 0x7FFFFFFF;
+        }
+        if(bits.u == 0x7F800000)
+        {
+            *p++ = 'i'; *p++ = 'n'; *p++ = 'f';
+            return p-out;
+        }
+        if(bits.u == 0)
+        {
+            *p++ = '0';
+            return p-out;
+        }
+
+        // anything between lo and hi rounds to this float. Halfway cases round
+        // to the even one, so lo and hi themselves count if this one is even.
+        u32b below, above;
+        below.u = bits.u - 1;
+        above.u = bits.u + 1;
+        double d = bits.f;
+        double lo = (d + double(below.f))/2;
+        double hi = (above.u == 0x7F800000) ? d + (d - double(below.f))/2 : (d + double(above.f))/2;
+        bool even = ((bits.u & 1) == 0);
+
+        // decimal exponent of the first digit
+        int32 k = ((int32((bits.u >> 23) & 0xFF) - 127)*1233) >> 12;
+        while(d >= ten_to(k+1))
+            k++;
+        while(d < ten_to(k))
+            k--;
+
+        // nine significant digits is always enough for a float
+        uint64 n = 0;
+        uint32 nd = 1;
+        for(; nd <= 9; nd++)
+        {
+            int32 s = int32(nd) - 1 - k;
+            double scaled = (s >= 0) ? d*ten_to(s) : d/ten_to(-s);
+            n = static_cast<uint64>(scaled);
+            if(scaled - double(n) >= 0.5)
+                n++;
+            double back = (s >= 0) ? double(n)/ten_to(s) : double(n)*ten_to(-s);
+            if((back > lo) && (back < hi))
+                break;
+            if(even && ((back == lo) || (back == hi)))
+                break;
+        }
+        if(nd > 9)
+            nd = 9;
+        if(n == powers_of_ten()[nd])
+        {
+            // rounded up to the next power of ten
+            n /= 10;
+            k++;
+        }
+        while((nd > 1) && (n%10 == 0))
+        {
+            n /= 10;
+            nd--;
+        }
+
+        char digits[10];
+        write_digits(digits+nd, n);
+
+        if((k >= -5) && (k < 9))
+        {
+            if(k >= 0)
+            {
+                for(int32 i = 0; i <= k; i++)
+                    *p++ = (i < int32(nd)) ? digits[i] : '0';
+                if(int32(nd) > k+1)
+                {
+                    *p++ = '.';
+                    for(uint32 i = k+1; i < nd; i++)
+                        *p++ = digits[i];
+                }
+            }
+            else
+            {
+                *p++ = '0';
+                *p++ = '.';
+                for(int32 i = 0; i < -k-1; i++)
+                    *p++ = '0';
+                for(uint32 i = 0; i < nd; i++)
+                    *p++ = digits[i];
+            }
+        }
+        else
+        {
+            *p++ = digits[0];
+            if(nd > 1)
+            {
+                *p++ = '.';
+                for(uint32 i = 1; i < nd; i++)
+                    *p++ = digits[i];
+            }
+            *p++ = 'e';
+            if(k < 0)
+            {
+                *p++ = '-';
+                k = -k;
+            }
+            p += format_uint(p, static_cast<uint32>(k));
+        }
+        return p-out;
+    }
+
+    /**
+     * \brief Writes a float with precision digits after the decimal point,
+     * or the shortest exact digits if precision is SHORTEST.
+     */
+    inline uint32 format_float(char* out, float v, uint8 precision)
+    {
+        if(precision == SHORTEST)
+            return format_shortest(out, v);
+        return format_fixed(out, v, precision);
+    }
+
+    inline uint32 format_float(char* out, double v, uint8 precision)
+    {
+        if(precision == SHORTEST)
+            return format_shortest(out, static_cast<float>(v));
+        return format_fixed(out, v, precision);
+    }
+
+}
+
+#endif
@@ -4,10 +4,19 @@
 
 
 #include "pool.h"
+#include "node_index.h"
 
 namespace etk
 {
 
+/**
+ * \class forward_list
+ *
+ * \brief A singly linked list with nodes allocated from a pool.
+ *
+ * get() carries on from the last item that was looked up, so stepping through the list by
+ * index is O(1) per step. enable_skip_index() speeds up random access into long lists.
+ */
 template <typename T> class forward_list
 {
 private:
@@ -68,7 +77,7 @@ public:
         typename forward_list::Node* node;
     };
 
-    forward_list(etk::Pool* pool) : pool(pool)
+    forward_list(etk::Pool* pool) : pool(pool), index(pool)
     {
 
     }
@@ -128,6 +137,7 @@ public:
         if(node == nullptr)
             return false;
         node->data = t;
+        index.invalidate();
 
         if(iter.node == head)
         {
@@ -159,8 +169,9 @@ public:
         if(node == nullptr)
             return false;
         node->data = t;
+        index.invalidate();
 
-        Node* pnext = iter.node->next->next;
+        Node* pnext = iter.node->next;
         iter.node->next = node;
         node->next = pnext;
         return true;
@@ -168,6 +179,7 @@ public:
 
     void remove_after(Iterator iter)
     {
+        index.invalidate();
         Node* pnext = iter.node->next->next;
         pool->free(iter.node->next);
         iter.node->next = pnext;
@@ -176,6 +188,7 @@ public:
 
     void remove_item(T t)
     {
+        index.invalidate();
         Node* node = head;
 
         if(node->data == t)
@@ -204,6 +217,7 @@ public:
 
     void remove_n(uint32 n)
     {
+        index.invalidate();
         uint32 c = 0;
         if(n == 0)
         {
@@ -236,6 +250,7 @@ public:
 
     void free()
     {
+        index.invalidate();
         Node* node = head;
         while(node != nullptr)
         {
@@ -255,6 +270,7 @@ public:
         node->data = t;
         node->next = head;
         head = node;
+        index.invalidate();
         return true;
     }
 
@@ -262,6 +278,7 @@ public:
     {
         if(head)
         {
+            index.invalidate();
             Node* pnext = head->next;
             pool->free(head);
             head = pnext;
@@ -271,21 +288,25 @@ public:
 
     T* get(uint32 n)
     {
-        if(n == 0)
-            return head;
+        Node* node = index.find(head, n);
+        if(node == nullptr)
+            return nullptr;
+        return &node->data;
+    }
 
-        Node* node = head;
-        uint32 c = 0;
-        while(node->next)
-        {
-            c++;
-            if(c > n)
-                return nullptr;
-            if(n == c)
-                return node->next;
-            node = node->next;
-        }
-        return nullptr;
+    /**
+     * \brief Keeps a pointer to every stride-th node so that get() can start close to any
+     * position. The index is allocated from the pool and rebuilt when it's next used after
+     * the list changes shape.
+     */
+    void enable_skip_index(uint32 stride)
+    {
+        index.enable_skip_index(stride);
+    }
+
+    void disable_skip_index()
+    {
+        index.disable_skip_index();
     }
 
     uint32 length()
@@ -304,6 +325,7 @@ private:
 
     Node* head = nullptr;
     etk::Pool* pool = nullptr;
+    NodeIndex<Node, etk::Pool> index;
 };
 
 }
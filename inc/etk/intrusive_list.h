@@ -0,0 +1,355 @@
+/*
+   Embedded Tool Kit
+   Copyright (C) 2015 Samuel Cowen
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_INTRUSIVE_LIST_H_INCLUDED
+#define ETK_INTRUSIVE_LIST_H_INCLUDED
+
+#include "types.h"
+
+
+namespace etk
+{
+
+    template <typename T, typename TAG> class IntrusiveList;
+
+    /**
+     * \brief The links that put an object on an IntrusiveList.
+     *
+     * An object becomes listable by inheriting from IntrusiveListHook. To be on
+     * more than one list at once, inherit from one hook per list and tell them
+     * apart with a TAG type.
+     *
+     * A hook unlinks itself when it's destroyed, and copying an object doesn't
+     * copy its place in a list.
+     */
+    template <typename TAG = void> class IntrusiveListHook
+    {
+        template <typename T, typename U> friend class IntrusiveList;
+
+        public:
+            IntrusiveListHook()
+            {
+            }
+
+            IntrusiveListHook(const IntrusiveListHook&)
+            {
+            }
+
+            IntrusiveListHook& operator = (const IntrusiveListHook&)
+            {
+                return *this;
+            }
+
+            ~IntrusiveListHook()
+            {
+                unlink();
+            }
+
+            /**
+             * \brief Returns true if the object is on a list.
+             */
+            bool is_linked() const
+            {
+                return next != nullptr;
+            }
+
+            /**
+             * \brief Takes the object off whatever list it's on. O(1).
+             */
+            void unlink()
+            {
+                if(next != nullptr)
+                {
+                    prev->next = next;
+                    next->prev = prev;
+                    prev = nullptr;
+                    next = nullptr;
+                }
+            }
+
+        private:
+            void link_before(IntrusiveListHook* pos)
+            {
+                prev = pos->prev;
+                next = pos;
+                pos->prev->next = this;
+                pos->prev = this;
+            }
+
+            IntrusiveListHook* prev = nullptr;
+            IntrusiveListHook* next = nullptr;
+    };
+
+
+    /**
+     * \class IntrusiveList
+     *
+     * \brief A doubly linked list of objects that carry their own links.
+     *
+     * The list never allocates. Objects inherit from IntrusiveListHook, which
+     * holds the links, so they can live anywhere: on the stack, in an array or
+     * in an ObjectArrayAllocator. Adding and removing are O(1), and an object
+     * can be removed knowing nothing but the object itself.
+     *
+     * The list doesn't own its objects. An object that is destroyed takes
+     * itself off the list, and a list that is destroyed unlinks everything on
+     * it. Inserting an object that is already on a list moves it.
+     *
+     * @code
+     struct Timer : public etk::IntrusiveListHook<>
+     {
+         uint32 expires;
+     };
+
+     etk::ObjectArrayAllocator<Timer, 32> timers;
+     etk::IntrusiveList<Timer> pending;
+
+     Timer* t = new(timers.alloc()) Timer();
+     pending.push_back(*t);
+     ...
+     pending.remove(*t);
+     @endcode
+     *
+     * @tparam T The type of object that the list contains.
+     * @tparam TAG Picks which IntrusiveListHook<TAG> base of T this list uses.
+     */
+    template <typename T, typename TAG = void> class IntrusiveList
+    {
+        typedef IntrusiveListHook<TAG> Hook;
+
+        public:
+            class Iterator
+            {
+                friend class IntrusiveList;
+                public:
+                    Iterator() : hook(nullptr) { }
+
+                    Iterator(Hook* h) : hook(h) { }
+
+                    T& operator*()
+                    {
+                        return *to_object(hook);
+                    }
+
+                    T* operator->()
+                    {
+                        return to_object(hook);
+                    }
+
+                    Iterator& operator++ ()
+                    {
+                        hook = hook->next;
+                        return *this;
+                    }
+
+                    Iterator operator++(int)
+                    {
+                        Iterator iter(*this);
+                        ++(*this);
+                        return iter;
+                    }
+
+                    Iterator& operator-- ()
+                    {
+                        hook = hook->prev;
+                        return *this;
+                    }
+
+                    Iterator operator--(int)
+                    {
+                        Iterator iter(*this);
+                        --(*this);
+                        return iter;
+                    }
+
+                    bool operator==(Iterator iter)
+                    {
+                        return (hook == iter.hook);
+                    }
+
+                    bool operator!=(Iterator iter)
+                    {
+                        return (hook != iter.hook);
+                    }
+
+                private:
+                    Hook* hook;
+            };
+
+            IntrusiveList()
+            {
+                root.prev = &root;
+                root.next = &root;
+            }
+
+            ~IntrusiveList()
+            {
+                clear();
+                root.prev = nullptr;
+                root.next = nullptr;
+            }
+
+            Iterator begin()
+            {
+                return Iterator(root.next);
+            }
+
+            Iterator end()
+            {
+                return Iterator(&root);
+            }
+
+            /**
+             * \brief Returns an iterator pointing at an object on this list.
+             */
+            Iterator iterator_to(T& t)
+            {
+                return Iterator(to_hook(t));
+            }
+
+            bool empty() const
+            {
+                return root.next == &root;
+            }
+
+            /**
+             * \brief Counts the objects on the list. This is O(N).
+             */
+            uint32 size() const
+            {
+                uint32 count = 0;
+                for(const Hook* h = root.next; h != &root; h = h->next) {
+                    count++;
+                }
+                return count;
+            }
+
+            void push_front(T& t)
+            {
+                link_before(t, root.next);
+            }
+
+            void push_back(T& t)
+            {
+                link_before(t, &root);
+            }
+
+            /**
+             * \brief Inserts t in front of the object that pos points at.
+             */
+            void insert(Iterator pos, T& t)
+            {
+                link_before(t, pos.hook);
+            }
+
+            /**
+             * \brief Takes t off the list. O(1).
+             */
+            void remove(T& t)
+            {
+                to_hook(t)->unlink();
+            }
+
+            /**
+             * \brief Removes the object that iter points at and returns an
+             * iterator to the one after it.
+             */
+            Iterator erase(Iterator iter)
+            {
+                Hook* next = iter.hook->next;
+                iter.hook->unlink();
+                return Iterator(next);
+            }
+
+            /**
+             * \brief Returns the first object, or nullptr if the list is empty.
+             */
+            T* front()
+            {
+                return empty() ? nullptr : to_object(root.next);
+            }
+
+            /**
+             * \brief Returns the last object, or nullptr if the list is empty.
+             */
+            T* back()
+            {
+                return empty() ? nullptr : to_object(root.prev);
+            }
+
+            /**
+             * \brief Removes and returns the first object, or nullptr if the list is empty.
+             */
+            T* pop_front()
+            {
+                T* t = front();
+                if(t != nullptr) {
+                    remove(*t);
+                }
+                return t;
+            }
+
+            /**
+             * \brief Removes and returns the last object, or nullptr if the list is empty.
+             */
+            T* pop_back()
+            {
+                T* t = back();
+                if(t != nullptr) {
+                    remove(*t);
+                }
+                return t;
+            }
+
+            /**
+             * \brief Unlinks every object.
+             */
+            void clear()
+            {
+                while(!empty()) {
+                    root.next->unlink();
+                }
+            }
+
+        private:
+            IntrusiveList(const IntrusiveList&);
+            IntrusiveList& operator = (const IntrusiveList&);
+
+            static Hook* to_hook(T& t)
+            {
+                return static_cast<Hook*>(&t);
+            }
+
+            static T* to_object(Hook* h)
+            {
+                return static_cast<T*>(h);
+            }
+
+            void link_before(T& t, Hook* pos)
+            {
+                Hook* h = to_hook(t);
+                if(h == pos) {
+                    return;
+                }
+                h->unlink();
+                h->link_before(pos);
+            }
+
+            Hook root;
+    };
+
+}
+
+#endif
@@ -4,12 +4,189 @@
 
 #include <stdint.h>
 #include "objpool.h"
+#include "relocate.h"
+#include "node_index.h"
 
 
 namespace etk
 {
 
-template <typename T, uint32 SLAB_SIZE = 12> class SingleLinkedList 
+/**
+ * \brief Hands out list nodes from slabs of SLAB_SIZE nodes that are allocated from a pool.
+ *
+ * A slab is allocated when all the others are full and given back to the pool once it's empty.
+ * Nodes are not constructed or destroyed here.
+ */
+template <typename NODE, uint32 SLAB_SIZE, typename POOL> class NodeSlabs
+{
+public:
+    typedef ObjectArrayAllocator<NODE, SLAB_SIZE> Slab;
+
+    NodeSlabs(POOL* pool) : pool(pool)
+    {
+        slab_list = nullptr;
+        slab_count = 0;
+        current_slab = 0;
+    }
+
+    NODE* alloc()
+    {
+        NODE* node = nullptr;
+
+        while(current_slab < slab_count) {
+            node = slab_list[current_slab]->alloc();
+            if(node == nullptr) {
+                current_slab++;
+            } else {
+                break;
+            }
+        }
+
+        // try add another slab
+        if(node == nullptr) {
+            if(!add_slab()) {
+                return nullptr;
+            }
+            node = slab_list[current_slab]->alloc();
+        }
+        return node;
+    }
+
+    void free(NODE* node)
+    {
+        //iterate over slab_list and free the node
+        for(uint32 i = 0; i < slab_count; i++) {
+            if(slab_list[i]->free(node)) {
+                // if the slab is empty, free it
+                if(slab_list[i]->available() == SLAB_SIZE) {
+                    slab_list[i]->~Slab();
+                    pool->free(slab_list[i]);
+
+                    // move the last slab into the freed slab's place
+                    if(slab_count > 1) {
+                        slab_list[i] = slab_list[slab_count - 1];
+                    }
+
+                    slab_count--;
+                    if(slab_count > 0) {
+                        // reallocate the slab list back to original size
+                        slab_list = (Slab**)pool->realloc(slab_list, sizeof(Slab*) * slab_count);
+                        // no need to check since this is either the same or smaller
+                        // realloc *cant* fail for this operation
+                    }
+                    else {
+                        pool->free(slab_list);
+                        slab_list = nullptr;
+                    }
+                }
+
+                current_slab = 0;
+                return;
+            }
+        }
+    }
+
+    /**
+     * \brief Adds slabs until there's room for n nodes in total.
+     * Nodes from new slabs are handed out in address order.
+     */
+    bool reserve(uint32 n)
+    {
+        while(slab_count*SLAB_SIZE < n) {
+            if(!add_slab()) {
+                return false;
+            }
+        }
+        current_slab = 0;
+        return true;
+    }
+
+    /**
+     * \brief Gives every slab back to the pool at once.
+     * Any nodes still in them must already have been destroyed.
+     */
+    void release()
+    {
+        for(uint32 i = 0; i < slab_count; i++) {
+            slab_list[i]->~Slab();
+            pool->free(slab_list[i]);
+        }
+        if(slab_list != nullptr) {
+            pool->free(slab_list);
+        }
+        slab_list = nullptr;
+        slab_count = 0;
+        current_slab = 0;
+    }
+
+    /**
+     * \brief Releases these slabs and takes over the slabs of another NodeSlabs.
+     */
+    void take(NodeSlabs& other)
+    {
+        release();
+        slab_list = other.slab_list;
+        slab_count = other.slab_count;
+        current_slab = other.current_slab;
+
+        other.slab_list = nullptr;
+        other.slab_count = 0;
+        other.current_slab = 0;
+    }
+
+    POOL* get_pool()
+    {
+        return pool;
+    }
+
+private:
+    bool add_slab()
+    {
+        // create new entry in slab_list
+        Slab** new_slab_list = (Slab**)pool->realloc(slab_list, sizeof(Slab*) * (slab_count + 1));
+        if(new_slab_list == nullptr) {
+            return false;
+        }
+        slab_list = new_slab_list;
+
+        // now allocate a new slab
+        Slab* slab = (Slab*)(pool->alloc(sizeof(Slab)));
+        if(slab == nullptr) {
+            return false;
+        }
+
+        // call placement new on the slab
+        new (slab) Slab();
+        slab_list[slab_count] = slab;
+        current_slab = slab_count;
+        slab_count++;
+        return true;
+    }
+
+    POOL* pool;
+    Slab** slab_list;
+    uint32 slab_count;
+    uint32 current_slab;
+};
+
+
+/**
+ * \class SingleLinkedList
+ *
+ * \brief A singly linked list whose nodes are carved out of slabs of SLAB_SIZE nodes.
+ *
+ * As items are added and removed, the order of the nodes in memory drifts away from the order of
+ * the list and walking it jumps around the slabs. defragment() copies the nodes into fresh slabs
+ * in list order, so that iterating is sequential again.
+ *
+ * get() and insert() carry on from the last item that was looked up, so stepping through the list
+ * by index is O(1) per step. enable_skip_index() speeds up random access into long lists.
+ *
+ * @tparam T The type of object that the list contains.
+ * @tparam SLAB_SIZE The number of nodes in each slab.
+ * @tparam POOL The type of memory pool that slabs come from.
+ */
+template <typename T, uint32 SLAB_SIZE = 12, typename POOL = Pool> class SingleLinkedList
 {
 private:
     struct Node;
@@ -19,7 +196,7 @@ public:
     {
         friend class SingleLinkedList;
     public:
-        Iterator() { 
+        Iterator() {
             node = nullptr;
         }
 
@@ -72,13 +249,10 @@ public:
         typename SingleLinkedList::Node* node;
     };
 
-    SingleLinkedList(Pool* pool) : pool(pool)
+    SingleLinkedList(POOL* pool) : slabs(pool), index(pool)
     {
         head = nullptr;
         tail = nullptr;
-        node_pool_list = nullptr;
-        node_pool_size = 0;
-        current_node_pool = 0;
     }
 
     ~SingleLinkedList()
@@ -92,11 +266,15 @@ public:
         return Iterator(head);
     }
 
+    Iterator end()
+    {
+        return Iterator(nullptr);
+    }
+
     Iterator append(T t)
     {
-        Node* node = allocate_node();
+        Node* node = allocate_node(t);
         if(node != nullptr) {
-            node->data = t;
             if(head == nullptr) {
                 head = node;
                 tail = node;
@@ -111,13 +289,16 @@ public:
         }
     }
 
-    Iterator insert(T t, uint32_t index) {
-        if(index == 0) {
-            Node* node = allocate_node();
+    Iterator insert(T t, uint32_t pos) {
+        if(pos == 0) {
+            Node* node = allocate_node(t);
             if(node != nullptr) {
-                node->data = t;
+                index.invalidate();
                 node->next = head;
                 head = node;
+                if(tail == nullptr) {
+                    tail = node;
+                }
                 return Iterator(node);
             }
             else {
@@ -125,39 +306,40 @@ public:
             }
         }
         else {
-            Node* node = head;
-            uint32_t i = 0;
-            while(node != nullptr) {
-                if(i == index - 1) {
-                    Node* new_node = allocate_node();
-                    if(new_node != nullptr) {
-                        new_node->data = t;
-                        new_node->next = node->next;
-                        node->next = new_node;
-                        return Iterator(new_node);
-                    }
-                    else {
-                        return Iterator(nullptr);
+            Node* node = index.find(head, pos - 1);
+            if(node != nullptr) {
+                Node* new_node = allocate_node(t);
+                if(new_node != nullptr) {
+                    index.invalidate();
+                    new_node->next = node->next;
+                    node->next = new_node;
+                    if(tail == node) {
+                        tail = new_node;
                     }
+                    return Iterator(new_node);
                 }
-                node = node->next;
-                i++;
             }
             return Iterator(nullptr);
         }
     }
 
-    Iterator get(uint32_t index) {
-        Node* node = head;
-        uint32_t i = 0;
-        while(node != nullptr) {
-            if(i == index) {
-                return Iterator(node);
-            }
-            node = node->next;
-            i++;
-        }
-        return Iterator(nullptr);
+    Iterator get(uint32_t pos) {
+        return Iterator(index.find(head, pos));
+    }
+
+    /**
+     * \brief Keeps a pointer to every stride-th node so that get() and insert() can start
+     * close to any position. The index is allocated from the pool and rebuilt when it's next
+     * used after the list changes shape.
+     */
+    void enable_skip_index(uint32 stride)
+    {
+        index.enable_skip_index(stride);
+    }
+
+    void disable_skip_index()
+    {
+        index.disable_skip_index();
     }
 
     /**
@@ -169,8 +351,12 @@ public:
         {
             T ret = head->data;
             auto next = head->next;
+            index.invalidate();
             free_node(head);
             head = next;
+            if(head == nullptr) {
+                tail = nullptr;
+            }
             return ret;
         }
         return T();
@@ -189,18 +375,23 @@ public:
         Iterator prev = begin();
         Iterator i = begin();
         i++;
-        while(i != iter)
+        while(i && (i != iter))
         {
             i++;
             prev++;
         }
         if(i) {
+            index.invalidate();
             prev.node->next = i.node->next;
+            if(tail == i.node) {
+                tail = prev.node;
+            }
             free_node(i.node);
         }
     }
 
     void clear() {
+        index.invalidate();
         while(head != nullptr) {
             auto next = head->next;
             free_node(head);
@@ -236,110 +427,430 @@ public:
         return false;
     }
 
+    /**
+     * \brief Moves the nodes into fresh slabs in list order, so that walking the list reads
+     * memory from start to end. Partly used slabs are packed together at the same time.
+     *
+     * New slabs are allocated before the old ones are freed, so the pool must have room
+     * for a second copy of the list. If it doesn't, the list is left alone and false is returned.
+     * Iterators are invalidated.
+     */
+    bool defragment()
+    {
+        NodeSlabs<Node, SLAB_SIZE, POOL> fresh(slabs.get_pool());
+        if(!fresh.reserve(size())) {
+            fresh.release();
+            return false;
+        }
+
+        index.invalidate();
+        Node* node = head;
+        Node* prev = nullptr;
+        head = nullptr;
+        while(node != nullptr)
+        {
+            Node* n = fresh.alloc();
+            new(&n->data) T(static_cast<T&&>(node->data));
+            n->next = nullptr;
+            node->data.~T();
+
+            if(prev == nullptr) {
+                head = n;
+            } else {
+                prev->next = n;
+            }
+            prev = n;
+            node = node->next;
+        }
+        tail = prev;
+
+        slabs.take(fresh);
+        return true;
+    }
+
     uint32 get_slab_size() {
         return sizeof(ObjectArrayAllocator<Node, SLAB_SIZE>);
     }
 
 private:
-    Node* allocate_node() {
-        Node* node = nullptr;
-
-        while(current_node_pool < node_pool_size) {
-           node = node_pool_list[current_node_pool]->alloc(); 
-           if(node == nullptr) {
-               current_node_pool++;
-           } else {
-                node->next = nullptr;
-                break;
-           }
-        } 
+    Node* allocate_node(const T& t) {
+        Node* node = slabs.alloc();
+        if(node != nullptr) {
+            new(&node->data) T(t);
+            node->next = nullptr;
+        }
+        return node;
+    }
 
-        // try add another pool
-        if(node == nullptr) {
-            node_pool_size++;
-            // try to allocate another pool, if it fails, return false
-            
-            // create new entry in node_pool_list
-            ObjectArrayAllocator<Node, SLAB_SIZE>** new_pool_list = 
-                (ObjectArrayAllocator<Node, SLAB_SIZE>**)pool->realloc(node_pool_list, sizeof(ObjectArrayAllocator<Node, SLAB_SIZE>*) * node_pool_size);
-            if(new_pool_list == nullptr) {
-                node_pool_size--;
-                return nullptr;
+    void free_node(Node* node)
+    {
+        // run the node data destructor
+        node->data.~T();
+        slabs.free(node);
+    }
+
+    struct Node
+    {
+        T data;
+        Node* next = nullptr;
+    };
+
+    Node* head = nullptr;
+    Node* tail = nullptr;
+
+    NodeSlabs<Node, SLAB_SIZE, POOL> slabs;
+    NodeIndex<Node, POOL> index;
+};
+
+
+
+/**
+ * \class UnrolledLinkedList
+ *
+ * \brief A singly linked list that keeps up to ITEMS items in each node.
+ *
+ * Storing several items per node means there are fewer pointers to follow and most steps of an
+ * iteration read the next item in the same node. Inserting into a full node splits it in half.
+ * A node is freed once it's empty, and defragment() packs the items back into full nodes in list
+ * order.
+ *
+ * Iterators are invalidated by insert(), remove() and defragment().
+ *
+ * @tparam T The type of object that the list contains.
+ * @tparam ITEMS The number of items in each node.
+ * @tparam SLAB_SIZE The number of nodes in each slab.
+ * @tparam POOL The type of memory pool that slabs come from.
+ */
+template <typename T, uint32 ITEMS = 8, uint32 SLAB_SIZE = 4, typename POOL = Pool> class UnrolledLinkedList
+{
+    static_assert(ITEMS >= 2, "Use SingleLinkedList for one item per node.");
+
+private:
+    struct Node;
+
+public:
+    class Iterator
+    {
+        friend class UnrolledLinkedList;
+    public:
+        Iterator() {
+            node = nullptr;
+            pos = 0;
+        }
+
+        Iterator(typename UnrolledLinkedList::Node* n, uint32 p = 0) : node(n), pos(p) { }
+
+        void next()
+        {
+            pos++;
+            if(pos >= node->count) {
+                node = node->next;
+                pos = 0;
             }
-            node_pool_list = new_pool_list;
+        }
 
-            // now allocate a new object pool
-            node_pool_list[current_node_pool] = (ObjectArrayAllocator<Node, SLAB_SIZE>*)
-                    (pool->alloc(sizeof(ObjectArrayAllocator<Node, SLAB_SIZE>)));
+        T& operator*()
+        {
+            return node->items()[pos];
+        }
 
-            // check if allocation was a win
-            if(node_pool_list[current_node_pool] == nullptr) {
-                node_pool_size--;
-                return nullptr;
+        Iterator& operator++ ()
+        {
+            next();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator iter(*this);
+            ++(*this);
+            return iter;
+        }
+
+        T* operator->()
+        {
+            return &node->items()[pos];
+        }
+
+        bool operator==(Iterator iter)
+        {
+            return (node == iter.node) && (pos == iter.pos);
+        }
+
+        bool operator!=(Iterator iter)
+        {
+            return !(*this == iter);
+        }
+
+        operator bool() const
+        {
+            return (node != nullptr);
+        }
+
+    private:
+        typename UnrolledLinkedList::Node* node;
+        uint32 pos;
+    };
+
+    UnrolledLinkedList(POOL* pool) : slabs(pool)
+    {
+        head = nullptr;
+        tail = nullptr;
+    }
+
+    ~UnrolledLinkedList()
+    {
+        clear();
+    }
+
+    Iterator begin()
+    {
+        return Iterator(head);
+    }
+
+    Iterator end()
+    {
+        return Iterator(nullptr);
+    }
+
+    Iterator append(const T& t)
+    {
+        if((tail == nullptr) || (tail->count == ITEMS))
+        {
+            Node* node = allocate_node();
+            if(node == nullptr) {
+                return Iterator(nullptr);
             }
+            if(tail == nullptr) {
+                head = node;
+            } else {
+                tail->next = node;
+            }
+            tail = node;
+        }
 
-            // call placement new on the object pool
-            new (node_pool_list[current_node_pool]) ObjectArrayAllocator<Node, SLAB_SIZE>();
-            node = node_pool_list[current_node_pool]->alloc();
-            node->next = nullptr;
+        new(&tail->items()[tail->count]) T(t);
+        tail->count++;
+        return Iterator(tail, tail->count - 1);
+    }
+
+    Iterator insert(const T& t, uint32 index)
+    {
+        uint32 pos = index;
+        Node* node = find(pos);
+        if(node == nullptr)
+        {
+            // one past the end is an append
+            if(pos == 0) {
+                return append(t);
+            }
+            return Iterator(nullptr);
         }
-        return node;
+
+        if(node->count == ITEMS)
+        {
+            // split the node and move the top half in to a new one
+            Node* upper = allocate_node();
+            if(upper == nullptr) {
+                return Iterator(nullptr);
+            }
+            uint32 keep = ITEMS/2;
+            relocate(upper->items(), &node->items()[keep], ITEMS - keep);
+            upper->count = ITEMS - keep;
+            node->count = keep;
+            upper->next = node->next;
+            node->next = upper;
+            if(tail == node) {
+                tail = upper;
+            }
+
+            if(pos > keep) {
+                pos -= keep;
+                node = upper;
+            }
+        }
+
+        T* items = node->items();
+        relocate(&items[pos+1], &items[pos], node->count - pos);
+        new(&items[pos]) T(t);
+        node->count++;
+        return Iterator(node, pos);
     }
 
-    void free_node(Node* node)
+    Iterator get(uint32 index)
     {
-        //iterate over node_pool_list and free the node
-        for(uint32 i = 0; i < node_pool_size; i++) {
-            if(node_pool_list[i]->free(node)) {
-                // run the node data destructor 
-                node->data.~T();
+        Node* node = find(index);
+        return Iterator(node, index);
+    }
 
-                if(i < current_node_pool) {
-                    current_node_pool = i;
+    /**
+     * \brief Removes and returns the first item on the list.
+     */
+    T pop_head()
+    {
+        if(head != nullptr)
+        {
+            T ret = head->items()[0];
+            remove(begin());
+            return ret;
+        }
+        return T();
+    }
+
+    /**
+     * \brief Removes an item from the list.
+     */
+    void remove(Iterator iter)
+    {
+        Node* node = iter.node;
+        if((node == nullptr) || (iter.pos >= node->count)) {
+            return;
+        }
+
+        T* items = node->items();
+        items[iter.pos].~T();
+        relocate(&items[iter.pos], &items[iter.pos+1], node->count - iter.pos - 1);
+        node->count--;
+
+        if(node->count == 0)
+        {
+            Node* prev = nullptr;
+            if(node != head)
+            {
+                prev = head;
+                while(prev->next != node) {
+                    prev = prev->next;
                 }
-                // if the pool is empty, free it
-                if(node_pool_list[i]->available() == SLAB_SIZE) {
-                    node_pool_list[i]->~ObjectArrayAllocator<Node, SLAB_SIZE>();
-                    pool->free(node_pool_list[i]);
-
-                    // move the last pool into the freed pool's place
-                    if(node_pool_size > 1) {
-                        node_pool_list[i] = node_pool_list[node_pool_size - 1];
-                    }
+            }
 
-                    node_pool_size--;
-                    if(node_pool_size > 0) {
-                        // reallocate the pool list back to original size
-                        node_pool_list = (ObjectArrayAllocator<Node, SLAB_SIZE>**)
-                            pool->realloc(node_pool_list, sizeof(ObjectArrayAllocator<Node, SLAB_SIZE>*) * node_pool_size);
-                        // no need to check since this is either the same or smaller
-                        // realloc *cant* fail for this operation
-                    }
-                    else {
-                        pool->free(node_pool_list);
-                        node_pool_list = nullptr;
+            if(prev == nullptr) {
+                head = node->next;
+            } else {
+                prev->next = node->next;
+            }
+            if(tail == node) {
+                tail = prev;
+            }
+            slabs.free(node);
+        }
+    }
+
+    void clear()
+    {
+        while(head != nullptr)
+        {
+            Node* next = head->next;
+            T* items = head->items();
+            for(uint32 i = 0; i < head->count; i++) {
+                items[i].~T();
+            }
+            slabs.free(head);
+            head = next;
+        }
+        tail = nullptr;
+    }
+
+    /**
+     * \brief Returns the number of items in the list.
+     */
+    uint32 size() const
+    {
+        uint32 count = 0;
+        for(Node* node = head; node != nullptr; node = node->next) {
+            count += node->count;
+        }
+        return count;
+    }
+
+    /**
+     * \brief Packs the items into full nodes in fresh slabs, in list order.
+     *
+     * New slabs are allocated before the old ones are freed, so the pool must have room
+     * for a second copy of the list. If it doesn't, the list is left alone and false is returned.
+     */
+    bool defragment()
+    {
+        uint32 n = size();
+        NodeSlabs<Node, SLAB_SIZE, POOL> fresh(slabs.get_pool());
+        if(!fresh.reserve((n + ITEMS - 1)/ITEMS)) {
+            fresh.release();
+            return false;
+        }
+
+        Node* node = head;
+        Node* out = nullptr;
+        head = nullptr;
+        while(node != nullptr)
+        {
+            T* items = node->items();
+            for(uint32 i = 0; i < node->count; i++)
+            {
+                if((out == nullptr) || (out->count == ITEMS))
+                {
+                    Node* fresh_node = fresh.alloc();
+                    fresh_node->next = nullptr;
+                    fresh_node->count = 0;
+                    if(out == nullptr) {
+                        head = fresh_node;
+                    } else {
+                        out->next = fresh_node;
                     }
+                    out = fresh_node;
                 }
-
-                current_node_pool = 0;
-                return;
+                relocate(&out->items()[out->count], &items[i], 1);
+                out->count++;
             }
+            node = node->next;
         }
+        tail = out;
+
+        slabs.take(fresh);
+        return true;
     }
 
+private:
     struct Node
     {
-        T data;
-        Node* next = nullptr;
+        Node* next;
+        uint32 count;
+        alignas(T) uint8 space[sizeof(T)*ITEMS];
+
+        T* items()
+        {
+            return (T*)space;
+        }
     };
 
-    Node* head = nullptr;
-    Node* tail = nullptr;
-    Pool* pool;
+    Node* allocate_node()
+    {
+        Node* node = slabs.alloc();
+        if(node != nullptr) {
+            node->next = nullptr;
+            node->count = 0;
+        }
+        return node;
+    }
+
+    // finds the node holding item index and turns index in to a position within it.
+    // returns nullptr if there is no such item, leaving index as how far past the end it was
+    Node* find(uint32& index)
+    {
+        Node* node = head;
+        while(node != nullptr)
+        {
+            if(index < node->count) {
+                return node;
+            }
+            index -= node->count;
+            node = node->next;
+        }
+        return nullptr;
+    }
+
+    Node* head;
+    Node* tail;
 
-    ObjectArrayAllocator<Node, SLAB_SIZE>** node_pool_list;
-    uint32 node_pool_size = 0;
-    uint32 current_node_pool = 0;
+    NodeSlabs<Node, SLAB_SIZE, POOL> slabs;
 };
 
 }
@@ -26,6 +26,7 @@ inline void *operator new(size_t, void *buf) {
 
 #include "types.h"
 #include "math_util.h"
+#include "relocate.h"
 
 namespace etk
 {
@@ -36,13 +37,20 @@ namespace etk
  * \brief The list class is an iterable container object. A list can contain up to a maximum number of items determined by the template parameter L.
  * List is supposed to provide a similar look and feel to std::vector, but without using dynamic memory allocation.
  *
+ * Items are constructed in place and moved rather than copied where possible, so List can hold
+ * types that own resources. Types that are trivially relocatable are shuffled along with memmove.
+ *
  * @tparam T The type of object that the list contains.
  * @tparam L The maximum size of the list.
+ * @tparam IDX The type used for positions and sizes. The default suits small MCUs; use uint32 for lists
+ * of more than 65535 items.
  */
 
 
-template <typename T, uint16 L> class List
+template <typename T, uint32 L, typename IDX = uint16> class List
 {
+    static_assert(L <= (uint32)(IDX)(~(IDX)0), "L is too big for the index type. Use a wider IDX.");
+
 public:
     List()
     {
@@ -51,22 +59,39 @@ public:
 
     ~List()
     {
-        T* pt = (T*)space;
-        for(uint32 i = 0; i < size(); i++)
-            (&pt[i])->~T();
+        clear();
     }
-    List(List& list)
+
+    List(const List& list)
     {
-        for(uint32 i = 0; i < sizeof(space); i++)
-            space[i] = list.space[i];
-        list_end = list.list_end;
+        list_end = -1;
+        copy_from(list);
     }
 
-    List(const List& list)
+    List(List&& list)
     {
-        for(uint32 i = 0; i < sizeof(space); i++)
-            space[i] = list.space[i];
-        list_end = list.list_end;
+        list_end = -1;
+        move_from(list);
+    }
+
+    List& operator = (const List& list)
+    {
+        if(this != &list)
+        {
+            clear();
+            copy_from(list);
+        }
+        return *this;
+    }
+
+    List& operator = (List&& list)
+    {
+        if(this != &list)
+        {
+            clear();
+            move_from(list);
+        }
+        return *this;
     }
 
     /**
@@ -150,14 +175,26 @@ public:
     /**
      * \brief Adds an item to the end of the list and increments the size of the list by 1.
      */
-    bool append(T t)
+    bool append(const T& t)
+    {
+        return emplace_back(t);
+    }
+
+    bool append(T&& t)
+    {
+        return emplace_back(static_cast<T&&>(t));
+    }
+
+    /**
+     * \brief Constructs an item at the end of the list from the given arguments.
+     */
+    template <typename... U> bool emplace_back(U&&... u)
     {
         if(size() < L)
         {
-            list_end++;
             T* pt = (T*)space;
-            pt += list_end;
-            new(pt)T(t);
+            new(&pt[list_end+1]) T(static_cast<U&&>(u)...);
+            list_end++;
             return true;
         }
         return false;
@@ -168,15 +205,26 @@ public:
      * @arg T the item to be inserted.
      * @arg pos where the item will be inserted. If pos is zero, then it will be inserted at the start of the list. If it's 1, it will become the second item in the list.
      */
-    bool insert(T t, uint32 pos)
+    bool insert(const T& t, uint32 pos)
+    {
+        return emplace(pos, t);
+    }
+
+    bool insert(T&& t, uint32 pos)
+    {
+        return emplace(pos, static_cast<T&&>(t));
+    }
+
+    /**
+     * \brief Constructs an item in the list at pos from the given arguments.
+     */
+    template <typename... U> bool emplace(uint32 pos, U&&... u)
     {
         if((pos <= size()) && (size() < L))
         {
             T* pt = (T*)space;
-            for(uint32 i = size(); i >= (pos+1); i--)
-                pt[i] = pt[i-1];
-
-            new(&pt[pos])T(t);
+            relocate(&pt[pos+1], &pt[pos], size()-pos);
+            new(&pt[pos]) T(static_cast<U&&>(u)...);
             list_end++;
 
             return true;
@@ -187,36 +235,28 @@ public:
     /**
      * \brief Removes an item from the list.
      * @arg pos The position of the item to remove.
-     * @arg padding A value / default object to fill in the space at the end of the list.
      */
-    void remove(uint16 pos)
+    void remove(IDX pos)
     {
-        if((pos < L) && (size() > 0))
+        if(pos < size())
         {
             T* pt = (T*)space;
             (&pt[pos])->~T();
-            for(uint32 i = pos; i < L-1; i++)
-                pt[i] = pt[i+1];
+            relocate(&pt[pos], &pt[pos+1], size()-pos-1);
             list_end--;
         }
     }
 
 
-    void remove_item(T& item)
+    void remove_item(const T& item)
     {
-        for(uint32 i = 0; i < size(); i++)
+        T* pt = (T*)space;
+        for(uint32 i = 0; i < size(); )
         {
-            T* pt = (T*)space;
-            if(*pt[i] == item)
-            {
+            if(pt[i] == item)
                 remove(i);
-                /*
-                delete &pt[pos];
-                for(int32 i = pos; i < L-1; i++)
-                    space[i] = space[i+1];
-                list_end--;
-                */
-            }
+            else
+                i++;
         }
     }
 
@@ -226,7 +266,7 @@ public:
      * @arg pos The position of the first item to erase.
      * @arg len The number of items to remove.
      */
-    void erase(uint16 pos, uint16 len)
+    void erase(IDX pos, IDX len)
     {
         //TODO calling remove() isn't very efficient
         for(uint32 i = 0; i < len; i++)
@@ -251,9 +291,9 @@ public:
      * @arg t The item to count.
      * @return The number of these items in the list.
      */
-    uint16 count(T t)
+    IDX count(const T& t)
     {
-        uint16 c = 0;
+        IDX c = 0;
         T* pt = (T*)space;
         auto sz = size();
         for(uint32 i = 0; i < sz; i++)
@@ -270,7 +310,7 @@ public:
      * @arg end The end position.
      * @arg f The item to fill with.
      */
-    void fill(uint16 start, uint16 end, T f)
+    void fill(IDX start, IDX end, const T& f)
     {
         T* pt = (T*)space;
         end = min(end, size());
@@ -286,9 +326,9 @@ public:
     T pop_back()
     {
         T* pt = (T*)space;
-        if(list_end > 0)
+        if(list_end >= 0)
         {
-            T ret = pt[list_end];
+            T ret(static_cast<T&&>(pt[list_end]));
             (&pt[list_end])->~T();
             list_end--;
             return ret;
@@ -299,15 +339,20 @@ public:
     /**
      * \brief Same as append();
      */
-    void push_back(T t)
+    void push_back(const T& t)
     {
         append(t);
     }
 
+    void push_back(T&& t)
+    {
+        append(static_cast<T&&>(t));
+    }
+
     /**
      * \brief This operator allows you to access elements of the list just like a normal array.
      */
-    T& operator[](uint16 pos)
+    T& operator[](IDX pos)
     {
         T* pt = (T*)space;
         if(pos < size())
@@ -315,12 +360,12 @@ public:
         return pt[L-1];
     }
 
-    T& get(uint16 pos)
+    T& get(IDX pos)
     {
         return (*this)[pos];
     }
 
-    T at(uint16 pos)
+    T at(IDX pos)
     {
         return (*this)[pos];
     }
@@ -328,7 +373,7 @@ public:
     /**
      * \brief Returns the number of items in the list.
      */
-    uint16 size()
+    IDX size()
     {
         return list_end+1;
     }
@@ -336,7 +381,7 @@ public:
     /**
      * \brief Returns the maximum possible number of items that the list can contain.
      */
-    uint16 max_len()
+    IDX max_len()
     {
         return L;
     }
@@ -344,7 +389,7 @@ public:
     /**
      * \brief Overrides the list end pointer. This function can be convenient but should be used with caution.
      */
-    void set_list_end(uint16 le)
+    void set_list_end(IDX le)
     {
         list_end = le;
     }
@@ -366,7 +411,21 @@ public:
     }
 
 private:
-    uint8 space[sizeof(T)*L];
+    void copy_from(const List& list)
+    {
+        const T* src = list.buffer();
+        for(int32 i = 0; i <= list.list_end; i++)
+            append(src[i]);
+    }
+
+    void move_from(List& list)
+    {
+        relocate((T*)space, list.raw_memory(), list.size());
+        list_end = list.list_end;
+        list.list_end = -1;
+    }
+
+    alignas(T) uint8 space[sizeof(T)*L];
     int32 list_end;
 };
 
@@ -0,0 +1,220 @@
+/*
+    Embedded Tool Kit
+    Copyright (C) 2015 Samuel Cowen
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+*/
+
+#ifndef ETK_MPMC_QUEUE_H
+#define ETK_MPMC_QUEUE_H
+
+#ifndef __AVR__
+
+#include <atomic>
+#include <thread>
+#include "types.h"
+
+namespace etk
+{
+    /*
+    MpmcQueue is a bounded lock-free queue that any number of threads can put
+    items on to and get items from.
+
+    Like RingBuffer it stores items in memory that it is given. It also needs
+    one sequence number per slot, which is given as a second array of the same
+    length. The number of slots is rounded down to a power of two.
+
+    Each slot's sequence number says whose turn it is. A producer claims the
+    slot at the enqueue position when its sequence equals the position, writes
+    the item and then sets the sequence to position + 1 to hand it to a
+    consumer. A consumer claims it when the sequence is position + 1, reads the
+    item and sets the sequence to position + capacity, which is when the next
+    producer around the ring will want it. Claiming a position is a single
+    compare and swap, and producers and consumers only meet on the slot they
+    are both interested in.
+
+    try_put() and try_get() return straight away if the queue is full or
+    empty. put() and get() yield until they succeed.
+
+    @code
+    Sample samples[256];
+    std::atomic<etk::uint32> sequence[256];
+    etk::MpmcQueue<Sample> queue(samples, sequence, 256);
+
+    void sensor_thread()
+    {
+        queue.put(read_sample());
+    }
+
+    void worker_thread()
+    {
+        Sample s;
+        if(queue.try_get(s))
+            process(s);
+    }
+    @endcode
+
+    T = type of object that is queued. It is copied in and out by assignment.
+    */
+    template <class T> class MpmcQueue
+    {
+        public:
+            /**
+             * \brief The constructor.
+             * @arg buffer Pointer to a writeable memory location for the items.
+             * @arg sequence An array of sz sequence numbers.
+             * @arg sz Number of items the memory can hold. Only the largest
+             * power of two that fits is used.
+             */
+            MpmcQueue(T* buffer, std::atomic<uint32>* sequence, uint32 sz)
+            {
+                uint32 n = 1;
+                while((n <= sz/2) && (n < 0x80000000)) {
+                    n <<= 1;
+                }
+
+                buf = buffer;
+                seq = sequence;
+                mask = n - 1;
+                for(uint32 i = 0; i < n; i++) {
+                    seq[i].store(i, std::memory_order_relaxed);
+                }
+                enqueue_pos.store(0, std::memory_order_relaxed);
+                dequeue_pos.store(0, std::memory_order_release);
+            }
+
+            /**
+             * \brief Returns the number of items the queue can hold.
+             */
+            uint32 capacity() const
+            {
+                return mask + 1;
+            }
+
+            /**
+             * \brief Returns roughly how many items are queued. Other threads
+             * can change it at any time.
+             */
+            uint32 available() const
+            {
+                uint32 d = dequeue_pos.load(std::memory_order_relaxed);
+                uint32 e = enqueue_pos.load(std::memory_order_relaxed);
+                int32 n = (int32)(e - d);
+                if(n < 0) {
+                    return 0;
+                }
+                if((uint32)n > capacity()) {
+                    return capacity();
+                }
+                return n;
+            }
+
+            /**
+             * \brief Puts an item on to the queue.
+             * \Returns false if the queue was full.
+             */
+            bool try_put(const T& t)
+            {
+                uint32 pos = enqueue_pos.load(std::memory_order_relaxed);
+                for(;;)
+                {
+                    uint32 s = seq[pos & mask].load(std::memory_order_acquire);
+                    int32 dif = (int32)(s - pos);
+                    if(dif == 0)
+                    {
+                        if(enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                    else if(dif < 0)
+                    {
+                        // the slot still holds an item from the last lap
+                        return false;
+                    }
+                    else
+                    {
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                buf[pos & mask] = t;
+                seq[pos & mask].store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * \brief Removes the next item from the queue.
+             * \Returns false if the queue was empty.
+             */
+            bool try_get(T& t)
+            {
+                uint32 pos = dequeue_pos.load(std::memory_order_relaxed);
+                for(;;)
+                {
+                    uint32 s = seq[pos & mask].load(std::memory_order_acquire);
+                    int32 dif = (int32)(s - (pos + 1));
+                    if(dif == 0)
+                    {
+                        if(dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                    else if(dif < 0)
+                    {
+                        // nothing has been written to the slot yet
+                        return false;
+                    }
+                    else
+                    {
+                        pos = dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                t = buf[pos & mask];
+                seq[pos & mask].store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * \brief Puts an item on to the queue, waiting for room if it's full.
+             */
+            void put(const T& t)
+            {
+                while(!try_put(t)) {
+                    std::this_thread::yield();
+                }
+            }
+
+            /**
+             * \brief Removes the next item from the queue, waiting for one if it's empty.
+             */
+            T get()
+            {
+                T t;
+                while(!try_get(t)) {
+                    std::this_thread::yield();
+                }
+                return t;
+            }
+
+        private:
+            alignas(64) std::atomic<uint32> enqueue_pos;
+            alignas(64) std::atomic<uint32> dequeue_pos;
+
+            alignas(64) T* buf;
+            std::atomic<uint32>* seq;
+            uint32 mask;
+    };
+}
+
+#endif
+
+#endif
@@ -0,0 +1,201 @@
+/*
+   Embedded Tool Kit
+   Copyright (C) 2015 Samuel Cowen
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_NODE_INDEX_H_INCLUDED
+#define ETK_NODE_INDEX_H_INCLUDED
+
+#include "types.h"
+
+
+namespace etk
+{
+
+    /**
+     * \brief Speeds up finding the nth node of a singly linked list.
+     *
+     * It remembers the last node that was found and where it was, so a loop
+     * that calls get(i) with increasing i carries on from the previous node
+     * instead of starting from the head each time.
+     *
+     * For random access into long lists a skip index can be turned on. It is
+     * an array, allocated from the pool, that points to every stride-th node.
+     * It's rebuilt the next time it's needed after the list changes shape, so
+     * it pays off when there are many lookups between changes.
+     *
+     * The list must call invalidate() whenever nodes are inserted or removed.
+     * Adding nodes to the end doesn't move any others, so append doesn't need to.
+     */
+    template <typename NODE, typename POOL> class NodeIndex
+    {
+        public:
+            NodeIndex(POOL* pool) : pool(pool)
+            {
+            }
+
+            /**
+             * \brief A copy keeps the stride but not the skip index or the
+             * cursor, which point at the other list's nodes. The skip index is
+             * rebuilt from the pool when it's next needed.
+             */
+            NodeIndex(const NodeIndex& other) : pool(other.pool), stride(other.stride)
+            {
+            }
+
+            NodeIndex& operator = (const NodeIndex& other)
+            {
+                if(this != &other)
+                {
+                    disable_skip_index();
+                    pool = other.pool;
+                    stride = other.stride;
+                    cursor = nullptr;
+                }
+                return *this;
+            }
+
+            ~NodeIndex()
+            {
+                disable_skip_index();
+            }
+
+            /**
+             * \brief Returns node n of the list that starts at head, or nullptr
+             * if the list is shorter than that.
+             */
+            NODE* find(NODE* head, uint32 n)
+            {
+                NODE* node = head;
+                uint32 at = 0;
+                if((cursor != nullptr) && (cursor_at <= n))
+                {
+                    node = cursor;
+                    at = cursor_at;
+                }
+
+                if(stride != 0)
+                {
+                    if(!skip_valid && !skip_failed) {
+                        rebuild(head);
+                    }
+                    if(skip_valid && (skip_count > 0))
+                    {
+                        uint32 k = n/stride;
+                        if(k >= skip_count) {
+                            k = skip_count - 1;
+                        }
+                        if(k*stride > at)
+                        {
+                            node = skip[k];
+                            at = k*stride;
+                        }
+                    }
+                }
+
+                while((node != nullptr) && (at < n))
+                {
+                    node = node->next;
+                    at++;
+                }
+
+                if(node != nullptr)
+                {
+                    cursor = node;
+                    cursor_at = n;
+                }
+                return node;
+            }
+
+            /**
+             * \brief Forgets the cursor and marks the skip index as out of date.
+             */
+            void invalidate()
+            {
+                cursor = nullptr;
+                skip_valid = false;
+                skip_failed = false;
+            }
+
+            /**
+             * \brief Keeps a pointer to every stride-th node.
+             */
+            void enable_skip_index(uint32 s)
+            {
+                stride = s;
+                skip_valid = false;
+                skip_failed = false;
+            }
+
+            /**
+             * \brief Frees the skip index.
+             */
+            void disable_skip_index()
+            {
+                if(skip != nullptr) {
+                    pool->free(skip);
+                }
+                skip = nullptr;
+                skip_count = 0;
+                skip_valid = false;
+                stride = 0;
+            }
+
+        private:
+            void rebuild(NODE* head)
+            {
+                uint32 len = 0;
+                for(NODE* node = head; node != nullptr; node = node->next) {
+                    len++;
+                }
+
+                uint32 count = (len + stride - 1)/stride;
+                if(count > skip_count)
+                {
+                    NODE** n = (NODE**)pool->realloc(skip, sizeof(NODE*)*count);
+                    if(n == nullptr) {
+                        // no room for the index, so just use the cursor. don't
+                        // try again until the list changes shape.
+                        skip_failed = true;
+                        return;
+                    }
+                    skip = n;
+                }
+
+                uint32 i = 0;
+                for(NODE* node = head; node != nullptr; node = node->next)
+                {
+                    if((i % stride) == 0) {
+                        skip[i/stride] = node;
+                    }
+                    i++;
+                }
+                skip_count = count;
+                skip_valid = true;
+            }
+
+            POOL* pool;
+
+            NODE* cursor = nullptr;
+            uint32 cursor_at = 0;
+
+            NODE** skip = nullptr;
+            uint32 skip_count = 0;
+            uint32 stride = 0;
+            bool skip_valid = false;
+            bool skip_failed = false;
+    };
+
+}
+
+#endif
@@ -15,6 +15,35 @@ namespace etk
             virtual T* alloc() = 0;
             // deallocates space for an object. note the object is not destructed
             virtual bool free(T* obj) = 0;
+
+            // allocates space for n objects and writes them to out. either all
+            // n are allocated and true is returned, or none are and it returns false
+            virtual bool alloc_n(T** out, uint32 n)
+            {
+                for(uint32 i = 0; i < n; i++)
+                {
+                    out[i] = alloc();
+                    if(out[i] == nullptr)
+                    {
+                        free_n(out, i);
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // deallocates n objects. returns false if any of them could not be freed
+            virtual bool free_n(T** objs, uint32 n)
+            {
+                bool ok = true;
+                for(uint32 i = 0; i < n; i++)
+                {
+                    if(!free(objs[i])) {
+                        ok = false;
+                    }
+                }
+                return ok;
+            }
     };
 
 
@@ -37,16 +66,31 @@ namespace etk
                     count++;
                 }
                 blocks[N_OBJECTS - 1].next = nullptr;
+
+#ifndef ETK_NO_POOL_STATS
+                n_free = N_OBJECTS;
+                high_water = 0;
+                failed_allocs = 0;
+#endif
             }
 
             T* alloc()
             {
                 Block *n = free_head;
                 if(n == nullptr) {
+#ifndef ETK_NO_POOL_STATS
+                    failed_allocs++;
+#endif
                     return nullptr;
                 }
 
                 free_head = free_head->next;
+#ifndef ETK_NO_POOL_STATS
+                n_free--;
+                if(N_OBJECTS - n_free > high_water) {
+                    high_water = N_OBJECTS - n_free;
+                }
+#endif
                 T* t = (T*)n;
                 return t;
             }
@@ -59,12 +103,82 @@ namespace etk
                     Block *n = (Block*)ptr;
                     n->next = free_head;
                     free_head = n;
+#ifndef ETK_NO_POOL_STATS
+                    n_free++;
+#endif
                     return true;
                 }
                 return false;
             }
 
+            /**
+             * Takes n objects off the front of the free list in one go.
+             */
+            bool alloc_n(T** out, uint32 n)
+            {
+                Block *b = free_head;
+                for(uint32 i = 0; i < n; i++)
+                {
+                    if(b == nullptr) {
+#ifndef ETK_NO_POOL_STATS
+                        failed_allocs++;
+#endif
+                        return false;
+                    }
+                    out[i] = (T*)b;
+                    b = b->next;
+                }
+
+                free_head = b;
+#ifndef ETK_NO_POOL_STATS
+                n_free -= n;
+                if(N_OBJECTS - n_free > high_water) {
+                    high_water = N_OBJECTS - n_free;
+                }
+#endif
+                return true;
+            }
+
+            /**
+             * Chains the objects together and pushes them on to the free list
+             * in one go. If any of them do not belong to this allocator then 
+             * nothing is freed and it returns false.
+             */
+            bool free_n(T** objs, uint32 n)
+            {
+                if(n == 0) {
+                    return true;
+                }
+
+                for(uint32 i = 0; i < n; i++)
+                {
+                    void* ptr = (void*)objs[i];
+                    if ((ptr < &blocks[0]) || (ptr > &blocks[N_OBJECTS - 1])) {
+                        return false;
+                    }
+                }
+
+                for(uint32 i = 0; i < n-1; i++)
+                {
+                    ((Block*)objs[i])->next = (Block*)objs[i+1];
+                }
+                ((Block*)objs[n-1])->next = free_head;
+                free_head = (Block*)objs[0];
+#ifndef ETK_NO_POOL_STATS
+                n_free += n;
+#endif
+                return true;
+            }
+
+            /**
+             * Returns the number of objects that can still be allocated.
+             * This is O(1) unless ETK_NO_POOL_STATS is defined, in which case
+             * the free list is counted.
+             */
             int available() {
+#ifndef ETK_NO_POOL_STATS
+                return n_free;
+#else
                 int count = 0;
                 Block *n = free_head;
                 while (n != nullptr)
@@ -73,8 +187,24 @@ namespace etk
                     n = n->next;
                 }
                 return count;
+#endif
             }
 
+#ifndef ETK_NO_POOL_STATS
+            /**
+             * Returns the occupancy counters of the allocator.
+             */
+            PoolStats stats() const
+            {
+                PoolStats st;
+                st.capacity = N_OBJECTS;
+                st.free = n_free;
+                st.high_water = high_water;
+                st.failed_allocs = failed_allocs;
+                return st;
+            }
+#endif
+
         private:
             union Block
             {
@@ -85,6 +215,11 @@ namespace etk
             Block blocks[N_OBJECTS];
 
             Block *free_head;
+#ifndef ETK_NO_POOL_STATS
+            uint32 n_free;
+            uint32 high_water;
+            uint32 failed_allocs;
+#endif
     };
 
     template<typename T> class ObjectPoolAllocator : public ObjectAllocator<T>
@@ -102,7 +237,22 @@ namespace etk
 
             bool free(T *obj_ptr)
             {
-                return pool->free(obj_ptr);
+                if(obj_ptr == nullptr) {
+                    return false;
+                }
+                pool->free(obj_ptr);
+                return true;
+            }
+
+            bool alloc_n(T** out, uint32 n)
+            {
+                return pool->alloc_n((void**)out, sizeof(T), n);
+            }
+
+            bool free_n(T** objs, uint32 n)
+            {
+                pool->free_n((void**)objs, n);
+                return true;
             }
 
         private:
@@ -0,0 +1,729 @@
+/*
+   Embedded Tool Kit
+   Copyright (C) 2015 Samuel Cowen
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_PARSE_H_INCLUDED
+#define ETK_PARSE_H_INCLUDED
+
+#include <string.h>
+#include "types.h"
+#include "format.h"
+
+
+/*
+ * Number parsing used by Rope and StaticString.
+ *
+ * parse_number works like std::from_chars. It reads a number from the start
+ * of [first, last), and says where the number ended and whether anything went
+ * wrong. It doesn't depend on the locale, and doesn't skip leading spaces.
+ *
+ * Runs of eight digits are converted at once with a few multiplies on a
+ * 64 bit word (SWAR) on little endian machines. Floats are correctly rounded
+ * for numbers with up to 19 significant digits; digits after that are
+ * dropped.
+ */
+
+// reading eight characters as a word only pays off on 32 and 64 bit targets
+#if !defined(__AVR__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ETK_PARSE_SWAR
+#endif
+
+namespace etk
+{
+
+    /**
+     * \brief The result of parse_number.
+     */
+    struct ParseResult
+    {
+        enum Error : uint8
+        {
+            OK,
+            NO_NUMBER,      // there was no number at the start
+            OUT_OF_RANGE    // too big for the type, the value is saturated
+        };
+
+        const char* end;    // the first character after the number
+        Error error;
+    };
+
+
+    /**
+     * \brief Converts eight digits at once if the next eight characters are
+     * all digits. Returns false if they aren't or there's fewer than eight.
+     */
+    inline bool parse_eight_digits(const char* p, const char* last, uint32& v)
+    {
+#ifdef ETK_PARSE_SWAR
+        if(last - p < 8)
+            return false;
+        uint64 chunk;
+        memcpy(&chunk, p, 8);
+        // every byte must be 0x30 to 0x39
+        if(((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+            return false;
+
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk*10) + (chunk >> 8);
+        chunk = (((chunk & 0x000000FF000000FFULL)*(100 + (1000000ULL << 32))) +
+            (((chunk >> 16) & 0x000000FF000000FFULL)*(1 + (10000ULL << 32)))) >> 32;
+        v = static_cast<uint32>(chunk);
+        return true;
+#else
+        (void)p;
+        (void)last;
+        (void)v;
+        return false;
+#endif
+    }
+
+    // reads digits in to v, remembering if it got bigger than a uint64
+    inline const char* parse_digits(const char* p, const char* last, uint64& v, bool& overflow)
+    {
+        uint32 eight;
+        while((v < 100000000000ULL) && parse_eight_digits(p, last, eight))
+        {
+            v = v*100000000 + eight;
+            p += 8;
+        }
+        while((p < last) && is_numeric(*p))
+        {
+            uint32 d = *p - '0';
+            if(v > (0xFFFFFFFFFFFFFFFFULL - d)/10)
+                overflow = true;
+            v = v*10 + d;
+            p++;
+        }
+        return p;
+    }
+
+    // reads an optional sign and the digits of an integer
+    inline ParseResult parse_integer(const char* first, const char* last, uint64& magnitude, bool& negative)
+    {
+        const char* p = first;
+        negative = false;
+        if((p < last) && ((*p == '-') || (*p == '+')))
+        {
+            negative = (*p == '-');
+            p++;
+        }
+
+        ParseResult r;
+        if((p == last) || !is_numeric(*p))
+        {
+            r.end = first;
+            r.error = ParseResult::NO_NUMBER;
+            return r;
+        }
+
+        bool overflow = false;
+        magnitude = 0;
+        r.end = parse_digits(p, last, magnitude, overflow);
+        r.error = overflow ? ParseResult::OUT_OF_RANGE : ParseResult::OK;
+        return r;
+    }
+
+    template <typename U> ParseResult parse_unsigned(const char* first, const char* last, U& value, uint64 max)
+    {
+        uint64 magnitude;
+        bool negative;
+        ParseResult r = parse_integer(first, last, magnitude, negative);
+        if(negative && (r.error != ParseResult::NO_NUMBER))
+        {
+            r.end = first;
+            r.error = ParseResult::NO_NUMBER;
+        }
+        if(r.error == ParseResult::NO_NUMBER)
+            return r;
+
+        if((r.error == ParseResult::OUT_OF_RANGE) || (magnitude > max))
+        {
+            r.error = ParseResult::OUT_OF_RANGE;
+            magnitude = max;
+        }
+        value = static_cast<U>(magnitude);
+        return r;
+    }
+
+    template <typename S> ParseResult parse_signed(const char* first, const char* last, S& value, uint64 max)
+    {
+        uint64 magnitude;
+        bool negative;
+        ParseResult r = parse_integer(first, last, magnitude, negative);
+        if(r.error == ParseResult::NO_NUMBER)
+            return r;
+
+        // the negative side goes one further
+        uint64 limit = negative ? max+1 : max;
+        if((r.error == ParseResult::OUT_OF_RANGE) || (magnitude > limit))
+        {
+            r.error = ParseResult::OUT_OF_RANGE;
+            magnitude = limit;
+        }
+        value = negative ? static_cast<S>(uint64(0) - magnitude) : static_cast<S>(magnitude);
+        return r;
+    }
+
+    /**
+     * \brief Parses an integer, with an optional + or - sign.
+     */
+    inline ParseResult parse_number(const char* first, const char* last, int32& value)
+    {
+        return parse_signed(first, last, value, 0x7FFFFFFFULL);
+    }
+
+    inline ParseResult parse_number(const char* first, const char* last, int64& value)
+    {
+        return parse_signed(first, last, value, 0x7FFFFFFFFFFFFFFFULL);
+    }
+
+    inline ParseResult parse_number(const char* first, const char* last, uint32& value)
+    {
+        return parse_unsigned(first, last, value, 0xFFFFFFFFULL);
+    }
+
+    inline ParseResult parse_number(const char* first, const char* last, uint64& value)
+    {
+        return parse_unsigned(first, last, value, 0xFFFFFFFFFFFFFFFFULL);
+    }
+
+
+    /**
+     * \brief Just enough of a big integer to compare a decimal number with the
+     * halfway point between two floats exactly.
+     */
+    template <uint32 WORDS> class ParseBigInt
+    {
+        public:
+            ParseBigInt(uint64 v)
+            {
+                n = 0;
+                while(v != 0)
+                {
+                    w[n++] = static_cast<uint32>(v);
+                    v >>= 32;
+                }
+            }
+
+            void multiply(uint32 m)
+            {
+                uint64 carry = 0;
+                for(uint32 i = 0; i < n; i++)
+                {
+                    uint64 t = uint64(w[i])*m + carry;
+                    w[i] = static_cast<uint32>(t);
+                    carry = t >> 32;
+                }
+                if((carry != 0) && (n < WORDS))
+                    w[n++] = static_cast<uint32>(carry);
+            }
+
+            void multiply_pow5(uint32 e)
+            {
+                static const uint32 pow5[14] = {
+                    1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125,
+                    9765625, 48828125, 244140625, 1220703125
+                };
+                while(e >= 13)
+                {
+                    multiply(pow5[13]);
+                    e -= 13;
+                }
+                multiply(pow5[e]);
+            }
+
+            void shift_left(uint32 s)
+            {
+                if(n == 0)
+                    return;
+                uint32 words = s/32;
+                uint32 bits = s%32;
+                uint32 top = (bits != 0) ? (w[n-1] >> (32-bits)) : 0;
+                for(uint32 i = n; i-- > 0;)
+                {
+                    uint32 lower = ((bits != 0) && (i > 0)) ? (w[i-1] >> (32-bits)) : 0;
+                    if(i+words < WORDS)
+                        w[i+words] = (w[i] << bits) | lower;
+                }
+                for(uint32 i = 0; (i < words) && (i < WORDS); i++)
+                    w[i] = 0;
+                n += words;
+                if((top != 0) && (n < WORDS))
+                    w[n++] = top;
+                if(n > WORDS)
+                    n = WORDS;
+            }
+
+            // only used when o is no bigger than this
+            void subtract(const ParseBigInt& o)
+            {
+                uint64 borrow = 0;
+                for(uint32 i = 0; i < n; i++)
+                {
+                    uint64 t = uint64(w[i]) - ((i < o.n) ? o.w[i] : 0) - borrow;
+                    w[i] = static_cast<uint32>(t);
+                    borrow = (t >> 32) & 1;
+                }
+                while((n > 0) && (w[n-1] == 0))
+                    n--;
+            }
+
+            bool is_zero() const
+            {
+                return n == 0;
+            }
+
+            int32 compare(const ParseBigInt& o) const
+            {
+                if(n != o.n)
+                    return (n < o.n) ? -1 : 1;
+                for(uint32 i = n; i-- > 0;)
+                {
+                    if(w[i] != o.w[i])
+                        return (w[i] < o.w[i]) ? -1 : 1;
+                }
+                return 0;
+            }
+
+        private:
+            uint32 w[WORDS];
+            uint32 n;
+    };
+
+
+    // the bit layout of IEEE 754 floats, picked by size because AVR doubles
+    // are only four bytes
+    template <uint32 SIZE> struct FloatLayout;
+
+    template <> struct FloatLayout<4>
+    {
+        typedef uint32 Bits;
+        static const uint32 MANTISSA_BITS = 23;
+        static const int32 BIAS = 127;
+        static const Bits INFINITY_BITS = 0x7F800000;
+        static const int32 MAX_EXP10 = 39;      // 10^39 is always too big
+        static const int32 MIN_EXP10 = -46;     // 10^-46 is always too small
+        static const uint64 EXACT_MANTISSA = 1ULL << 24;
+        static const int32 EXACT_EXP10 = 10;
+        static const uint32 BIG_WORDS = 10;
+    };
+
+    template <> struct FloatLayout<8>
+    {
+        typedef uint64 Bits;
+        static const uint32 MANTISSA_BITS = 52;
+        static const int32 BIAS = 1023;
+        static const Bits INFINITY_BITS = 0x7FF0000000000000ULL;
+        static const int32 MAX_EXP10 = 309;
+        static const int32 MIN_EXP10 = -324;
+        static const uint64 EXACT_MANTISSA = 1ULL << 53;
+        static const int32 EXACT_EXP10 = 22;
+        static const uint32 BIG_WORDS = 40;
+    };
+
+    template <typename F> class DecimalToFloat
+    {
+        typedef FloatLayout<sizeof(F)> Layout;
+        typedef typename Layout::Bits Bits;
+        typedef ParseBigInt<Layout::BIG_WORDS> Big;
+
+        public:
+            /**
+             * \brief Returns m*10^e rounded to the nearest F, and sets overflow if
+             * that's too big.
+             */
+            static F convert(uint64 m, uint32 digits, int32 e, bool& overflow)
+            {
+                overflow = false;
+                if((m == 0) || (int32(digits) + e < Layout::MIN_EXP10))
+                    return 0;
+                if(int32(digits) + e > Layout::MAX_EXP10)
+                {
+                    overflow = true;
+                    return from_bits(Layout::INFINITY_BITS);
+                }
+
+                // when m and 10^e are exact in F, one operation rounds correctly
+                if((m <= Layout::EXACT_MANTISSA) && (e >= -Layout::EXACT_EXP10) && (e <= Layout::EXACT_EXP10))
+                {
+                    F p = static_cast<F>(ten_to(e < 0 ? -e : e));
+                    return (e < 0) ? static_cast<F>(m)/p : static_cast<F>(m)*p;
+                }
+
+                // otherwise get close in double and settle it exactly
+                double d;
+                if(e < -300)
+                    d = double(m)/ten_to(-e-300)/1e300;
+                else
+                    d = double(m)*ten_to(e);
+
+                Bits b = to_bits(static_cast<F>(d));
+                if(b > Layout::INFINITY_BITS)
+                    b = Layout::INFINITY_BITS;
+                for(;;)
+                {
+                    if(b < Layout::INFINITY_BITS)
+                    {
+                        int32 c = compare_halfway(m, e, b);
+                        if((c > 0) || ((c == 0) && (b & 1)))
+                        {
+                            b++;
+                            continue;
+                        }
+                    }
+                    if(b > 0)
+                    {
+                        int32 c = compare_halfway(m, e, b-1);
+                        if((c < 0) || ((c == 0) && (b & 1)))
+                        {
+                            b--;
+                            continue;
+                        }
+                    }
+                    break;
+                }
+                overflow = (b == Layout::INFINITY_BITS);
+                return from_bits(b);
+            }
+
+            /**
+             * \brief Rounds a number with more digits than convert() can take.
+             *
+             * The number is between lower and the next float up. Every digit
+             * from first to last is compared with the halfway point between
+             * them to pick one. exp10 is the power of ten that puts the
+             * decimal point in front of the first digit that isn't zero.
+             */
+            static F round_digits(const char* first, const char* last, int32 exp10, F lower, bool& overflow)
+            {
+                Bits b = to_bits(lower);
+                int32 c = compare_digits(first, last, exp10, b);
+                if((c > 0) || ((c == 0) && (b & 1)))
+                    b++;
+                overflow = (b == Layout::INFINITY_BITS);
+                return from_bits(b);
+            }
+
+        private:
+            static Bits to_bits(F f)
+            {
+                Bits b;
+                memcpy(&b, &f, sizeof(F));
+                return b;
+            }
+
+            static F from_bits(Bits b)
+            {
+                F f;
+                memcpy(&f, &b, sizeof(F));
+                return f;
+            }
+
+            // value of positive float bits b as mantissa*2^exponent. Infinity
+            // comes out as the next power of two after the largest float.
+            static void split(Bits b, uint64& mantissa, int32& exponent)
+            {
+                int32 biased = static_cast<int32>(b >> Layout::MANTISSA_BITS);
+                mantissa = b & ((Bits(1) << Layout::MANTISSA_BITS) - 1);
+                if(biased == 0)
+                    exponent = 1 - Layout::BIAS - int32(Layout::MANTISSA_BITS);
+                else
+                {
+                    mantissa |= (uint64(1) << Layout::MANTISSA_BITS);
+                    exponent = biased - Layout::BIAS - int32(Layout::MANTISSA_BITS);
+                }
+            }
+
+            // the point halfway between floats b and b+1 as halfway*2^k
+            static void halfway_point(Bits b, uint64& halfway, int32& k)
+            {
+                uint64 ma, mb;
+                int32 ea, eb;
+                split(b, ma, ea);
+                split(b+1, mb, eb);
+                k = (ea < eb) ? ea : eb;
+                halfway = (ma << (ea-k)) + (mb << (eb-k));
+                k -= 1;
+            }
+
+            // compares m*10^e with the point halfway between floats b and b+1
+            static int32 compare_halfway(uint64 m, int32 e, Bits b)
+            {
+                uint64 halfway;
+                int32 k;
+                halfway_point(b, halfway, k);
+
+                // m*5^e*2^e against halfway*2^k, all in integers
+                Big lhs(m);
+                Big rhs(halfway);
+                if(e >= 0)
+                    lhs.multiply_pow5(e);
+                else
+                    rhs.multiply_pow5(-e);
+                if(e > k)
+                    lhs.shift_left(e-k);
+                else
+                    rhs.shift_left(k-e);
+                return lhs.compare(rhs);
+            }
+
+            // compares 0.d1d2d3...*10^exp10 with the point halfway between
+            // floats b and b+1, one digit at a time. The halfway point divided
+            // by 10^exp10 is kept as the fraction num/den, and each step takes
+            // its next decimal digit by long division.
+            static int32 compare_digits(const char* first, const char* last, int32 exp10, Bits b)
+            {
+                uint64 halfway;
+                int32 k;
+                halfway_point(b, halfway, k);
+
+                Big num(halfway);
+                Big den(1);
+                if(exp10 < 0)
+                    num.multiply_pow5(-exp10);
+                else
+                    den.multiply_pow5(exp10);
+                int32 twos = k - exp10;
+                if(twos > 0)
+                    num.shift_left(twos);
+                else
+                    den.shift_left(-twos);
+
+                const char* p = first;
+                while((p < last) && ((*p == '0') || (*p == '.')))
+                    p++;
+                for(; p < last; p++)
+                {
+                    if(*p == '.')
+                        continue;
+                    num.multiply(10);
+                    uint32 q = 0;
+                    while(num.compare(den) >= 0)
+                    {
+                        num.subtract(den);
+                        q++;
+                    }
+                    uint32 d = *p - '0';
+                    if(d != q)
+                        return (d > q) ? 1 : -1;
+                }
+                return num.is_zero() ? 0 : -1;
+            }
+    };
+
+    inline bool match_word(const char* p, const char* last, const char* word)
+    {
+        for(; *word != '\0'; p++, word++)
+        {
+            if((p == last) || (to_lower(*p) != *word))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename F> ParseResult parse_float(const char* first, const char* last, F& value)
+    {
+        ParseResult r;
+        const char* p = first;
+        bool negative = false;
+        if((p < last) && ((*p == '-') || (*p == '+')))
+        {
+            negative = (*p == '-');
+            p++;
+        }
+
+        if(match_word(p, last, "nan"))
+        {
+            value = static_cast<F>(NAN);
+            r.end = p+3;
+            r.error = ParseResult::OK;
+            return r;
+        }
+        if(match_word(p, last, "inf"))
+        {
+            value = negative ? -static_cast<F>(INFINITY) : static_cast<F>(INFINITY);
+            r.end = match_word(p, last, "infinity") ? p+8 : p+3;
+            r.error = ParseResult::OK;
+            return r;
+        }
+
+        // up to 19 significant digits go in to m, the rest are dropped
+        const char* mantissa = p;
+        uint64 m = 0;
+        uint32 digits = 0;
+        int32 e = 0;
+        bool seen_digit = false;
+        bool truncated = false;
+        uint32 eight;
+        while((p < last) && is_numeric(*p))
+        {
+            seen_digit = true;
+            if((digits <= 11) && parse_eight_digits(p, last, eight))
+            {
+                m = m*100000000 + eight;
+                digits = (m == 0) ? 0 : count_digits(m);
+                p += 8;
+                continue;
+            }
+            if(digits < 19)
+            {
+                m = m*10 + (*p - '0');
+                if(m != 0)
+                    digits++;
+            }
+            else
+            {
+                e++;
+                if(*p != '0')
+                    truncated = true;
+            }
+            p++;
+        }
+        if((p < last) && (*p == '.'))
+        {
+            p++;
+            while((p < last) && is_numeric(*p))
+            {
+                seen_digit = true;
+                if((digits <= 11) && parse_eight_digits(p, last, eight))
+                {
+                    m = m*100000000 + eight;
+                    digits = (m == 0) ? 0 : count_digits(m);
+                    e -= 8;
+                    p += 8;
+                    continue;
+                }
+                if(digits < 19)
+                {
+                    m = m*10 + (*p - '0');
+                    if(m != 0)
+                        digits++;
+                    e--;
+                }
+                else if(*p != '0')
+                    truncated = true;
+                p++;
+            }
+        }
+        const char* mantissa_end = p;
+
+        if(!seen_digit)
+        {
+            r.end = first;
+            r.error = ParseResult::NO_NUMBER;
+            return r;
+        }
+
+        // the exponent only counts if it has digits
+        if((p < last) && ((*p == 'e') || (*p == 'E')))
+        {
+            const char* q = p+1;
+            bool negative_exp = false;
+            if((q < last) && ((*q == '-') || (*q == '+')))
+            {
+                negative_exp = (*q == '-');
+                q++;
+            }
+            if((q < last) && is_numeric(*q))
+            {
+                int32 x = 0;
+                while((q < last) && is_numeric(*q))
+                {
+                    if(x < 100000)
+                        x = x*10 + (*q - '0');
+                    q++;
+                }
+                e += negative_exp ? -x : x;
+                p = q;
+            }
+        }
+
+        bool overflow;
+        F f = DecimalToFloat<F>::convert(m, digits, e, overflow);
+        if(truncated && !overflow)
+        {
+            // the dropped digits put the number between m and m+1. If those
+            // round differently, all the digits are needed to decide.
+            bool up_overflow;
+            F up = DecimalToFloat<F>::convert(m+1, count_digits(m+1), e, up_overflow);
+            if(up != f)
+                f = DecimalToFloat<F>::round_digits(mantissa, mantissa_end, int32(digits)+e, f, overflow);
+        }
+        value = negative ? -f : f;
+        r.end = p;
+        r.error = overflow ? ParseResult::OUT_OF_RANGE : ParseResult::OK;
+        return r;
+    }
+
+    /**
+     * \brief Parses a decimal number like 12, -0.5, 6.02e23, nan or inf.
+     * Numbers too big for the type come back as infinity and OUT_OF_RANGE.
+     */
+    inline ParseResult parse_number(const char* first, const char* last, float& value)
+    {
+        return parse_float(first, last, value);
+    }
+
+    inline ParseResult parse_number(const char* first, const char* last, double& value)
+    {
+        return parse_float(first, last, value);
+    }
+
+    /**
+     * \brief Parses every field of a delimited line in one pass.
+     *
+     * Each field is parsed from its start, so '12*4F' reads as 12. Fields
+     * with no number are 0, and their error is NO_NUMBER. The line ends at
+     * last or a null character.
+     *
+     @code
+     const char* line = "$PTMP,21.5,22.0,,19.75";
+     float temps[8];
+     etk::ParseResult::Error errors[8];
+     uint32 n = etk::parse_fields(line, line+strlen(line), ',', temps, 8, errors);
+     //n == 5, errors[0] and errors[3] are NO_NUMBER
+     @endcode
+     * @return the number of fields, up to max_fields.
+     */
+    template <typename T> uint32 parse_fields(const char* first, const char* last, char delimiter,
+        T* values, uint32 max_fields, ParseResult::Error* errors = nullptr)
+    {
+        uint32 count = 0;
+        const char* p = first;
+        if((p == last) || (*p == '\0'))
+            return 0;
+
+        while(count < max_fields)
+        {
+            T v = 0;
+            ParseResult r = parse_number(p, last, v);
+            values[count] = (r.error == ParseResult::NO_NUMBER) ? 0 : v;
+            if(errors != nullptr)
+                errors[count] = r.error;
+            count++;
+
+            p = r.end;
+            while((p < last) && (*p != delimiter) && (*p != '\0'))
+                p++;
+            if((p == last) || (*p != delimiter))
+                break;
+            p++;
+        }
+        return count;
+    }
+
+}
+
+#endif
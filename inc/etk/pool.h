@@ -19,6 +19,7 @@
 #include <string.h>
 #include "types.h"
 #include "math_util.h"
+#include "ring_buffer.h"
 
 
 
@@ -28,6 +29,15 @@
 
 namespace etk
 {
+    /**
+     * The interface for memory pools.
+     *
+     * DynamicList, SingleLinkedList and pool_pointer take the pool type as a
+     * template parameter that defaults to Pool. With the default every call
+     * goes through the vtable and any pool can be used at run time. Naming a 
+     * concrete pool instead (e.g. DynamicList<int, 1, MemPool<4096>>) lets 
+     * the compiler call and inline the pool directly.
+     */
     class Pool
     {
         public:
@@ -37,6 +47,100 @@ namespace etk
             virtual uint32 coalesce() = 0;
             virtual uint32 ref(void* ptr) = 0;
             virtual uint32 unref(void* ptr) = 0;
+
+            /**
+             * Allocates n blocks of at least sz bytes each and writes them to
+             * out. Either all n blocks are allocated and true is returned, or 
+             * nothing is allocated and false is returned.
+             *
+             * This default allocates the blocks one at a time. Pools that can
+             * carve a batch out of one region should override it.
+             */
+            virtual bool alloc_n(void** out, uint32 sz, uint32 n)
+            {
+                for(uint32 i = 0; i < n; i++)
+                {
+                    out[i] = alloc(sz);
+                    if(out[i] == nullptr)
+                    {
+                        free_n(out, i);
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * Frees n blocks. Null pointers are skipped.
+             */
+            virtual void free_n(void** ptrs, uint32 n)
+            {
+                for(uint32 i = 0; i < n; i++)
+                {
+                    free(ptrs[i]);
+                }
+            }
+    };
+
+#ifndef ETK_NO_POOL_STATS
+    /**
+     * Occupancy counters for memory pools and object allocators.
+     *
+     * The counters are updated as memory is allocated and freed, so reading 
+     * them is O(1). For MemPool the unit is a chunk, for object allocators it
+     * is an object.
+     *
+     * Define ETK_NO_POOL_STATS to remove the counters entirely.
+     */
+    struct PoolStats
+    {
+        uint32 capacity;      // total number of chunks / objects
+        uint32 free;          // number currently free
+        uint32 high_water;    // the most that have ever been in use at once
+        uint32 failed_allocs; // number of allocations that returned nullptr
+    };
+#endif
+
+    /**
+     * One record of the MemPool allocation trace.
+     */
+    struct AllocTrace
+    {
+        enum Op : uint8
+        {
+            ALLOC,
+            FREE,
+            REALLOC,
+            ALLOC_N,
+            FREE_N
+        };
+
+        Op op;
+        bool ok;        // false if the allocation failed
+        uint32 size;    // bytes requested, or the block size for frees
+        uint32 chunks;  // chunks held by the block afterwards, or released
+        uint32 latency; // clock ticks taken, zero if there is no clock
+    };
+
+    /**
+     * A snapshot of how the free memory in a MemPool is laid out.
+     *
+     * histogram[n] is the number of free runs with a length in chunks between
+     * 2^n and 2^(n+1)-1. The last bucket also counts anything longer.
+     *
+     * external_fragmentation is 1 - largest_free_run/free_chunks. Zero means 
+     * all free memory is in one run, values near one mean it is scattered in
+     * pieces too small to satisfy a big allocation.
+     */
+    struct FragmentationReport
+    {
+        static const uint32 N_BUCKETS = 16;
+
+        uint32 free_chunks;
+        uint32 free_runs;
+        uint32 largest_free_run;
+        uint32 histogram[N_BUCKETS];
+        real_t external_fragmentation;
     };
 
     /*
@@ -63,13 +167,23 @@ namespace etk
      * This is a memory pool implementation that uses a free list to track
      * unused chunks.
      *
+     * A free block writes its size in its last chunk as well as its header
+     * (a boundary tag), and every block has a bit that says whether the block
+     * physically before it is free. That lets free() find and merge a block
+     * with both of its neighbours straight away, without making the header of
+     * an allocated block any bigger. Free blocks are therefore never adjacent and the pool
+     * does not need to be coalesced when it runs low on memory.
+     *
+     * MemPool is final, so containers that take it as their POOL template
+     * parameter call it directly instead of through the Pool vtable.
+     *
      * SIZE = number of bytes to reserve for the pool
      * CHUNK_SIZE = the size of the blocks. bigger blocks usually perform 
      * better than small blocks, but will reduce the number of available 
      * blocks to allocate. 
      *
      */
-    template <uint32 SIZE, uint32 CHUNK_SIZE = 64> class MemPool : public Pool
+    template <uint32 SIZE, uint32 CHUNK_SIZE = 64> class MemPool final : public Pool
     {
         public:
             MemPool()
@@ -88,15 +202,25 @@ namespace etk
             void begin()
             {
                 static_assert(SIZE%CHUNK_SIZE == 0, "The memory pool size must be a multiple of the chunk size.");
-                static_assert(CHUNK_SIZE > sizeof(BlockHead), "CHUNK_SIZE is too small.");
+                static_assert(CHUNK_SIZE >= sizeof(BlockHead) + sizeof(uint32), "CHUNK_SIZE is too small.");
 
                 memset(&blocks[0], 0, sizeof(Block)*TOTAL_CHUNKS);
 
                 free_head = &blocks[0];
                 blocks[0].head.size = TOTAL_CHUNKS;
+                blocks[0].head.prev_free = 0;
                 blocks[0].head.next = nullptr;
                 blocks[0].head.prev = nullptr;
                 blocks[0].head.ref = 0;
+                update_next_tag(&blocks[0]);
+
+#ifndef ETK_NO_POOL_STATS
+                n_free = TOTAL_CHUNKS;
+                high_water = 0;
+                failed_allocs = 0;
+#endif
+                trace_buf = nullptr;
+                trace_clock = nullptr;
             }
 
             /**
@@ -104,147 +228,129 @@ namespace etk
              */
             void* alloc(uint32 sz)
             {
-                void* r = nullptr;
-                //first see if there is a suitable block
-                r = alloc_from_free_list(sz);
-                if(r == nullptr) {
-                    //we're out of memory, so try joining together all the adjacent free blocks to see if they release a region large enough
-                    coalesce();
-                    //after merging free blocks, there might be a large enough block free
-                    r = alloc_from_free_list(sz);
-                }        
-
+                // free blocks are merged as they are released, so if there is
+                // no suitable block now, coalescing won't produce one
+                uint32 t = trace_begin();
+                void* r = alloc_from_free_list(sz);
+                note_alloc(r);
+                trace_end(AllocTrace::ALLOC, t, sz, r);
                 return r;
             }
 
             /**
              * realloc will resize an allocation to make it either bigger or smaller
              */
-            void* realloc(void* ptr, uint32 sz)/*{{{*/
+            void* realloc(void* ptr, uint32 sz)
             {
-                /*
-                if(ptr == nullptr) {
-                    return alloc(sz);
-                }
-
-                free(ptr);
-                void* n_ptr = alloc(sz);
-                if((n_ptr != nullptr) && (n_ptr != ptr)) {
-                    memcpy(n_ptr, ptr, sz);
-                }
-                return n_ptr;
-                */
                 if(ptr == nullptr)
                 {
                     return alloc(sz);
                 }
 
-                uint8* bptr = (uint8*)ptr;
-                bptr -= sizeof(BlockHead);
-                Block* block = (Block*)bptr;
-                uint32 old_chunks = block->head.size;
-
-
-                // calculate the number of chunks to allocate
-                uint32 N = sz+sizeof(BlockHead);
-                uint32 n_chunks = N / CHUNK_SIZE + ((N % CHUNK_SIZE != 0) * 1) ;
+                uint32 t = trace_begin();
+                void* r = resize(ptr, sz);
+                trace_end(AllocTrace::REALLOC, t, sz, r);
+                return r;
+            }
 
-                //the allocation needs to be shrunk down
-                if(old_chunks > n_chunks)
+            /* 
+             * free releases a block of memory back to the memory pool.
+             */
+            void free(void* ptr)/*{{{*/
+            {
+                if(ptr != nullptr) 
                 {
-                    split_block(block, n_chunks);
-                    return ptr;
+                    uint32 t = trace_begin();
+                    Block* block = block_of(ptr);
+                    uint32 chunks = block->head.size;
+                    release(block);
+                    trace_end(AllocTrace::FREE, t, chunks*CHUNK_SIZE, chunks);
                 }
-                //the allocation needs to grow larger
-                else if(old_chunks < n_chunks)
-                {
-                    // first attempt to join on any adjacent free blocks
-                    uint32 blocknumber = (block - blocks);
-                    join_adjacent(blocknumber);
+            }/*}}}*/
 
-                    if(block->head.size > n_chunks)  // if the block size is now too big
-                    {
-                        split_block(block, n_chunks); // split it
-                        return ptr; // return original pointer because nothing moved
-                    }
-                    else if(block->head.size == n_chunks) // if the block size is perfect
-                    {
-                        return ptr; 
-                    }
-                    else // worst case scenario
-                    {
-                        // free the memory
-                        free(ptr);
+            /**
+             * alloc_n allocates n blocks of at least sz bytes each. The blocks
+             * are carved out of a single free run, so the free list is only 
+             * touched once. If no run is big enough they are allocated one at
+             * a time.
+             */
+            bool alloc_n(void** out, uint32 sz, uint32 n)
+            {
+                if(n == 0) {
+                    return true;
+                }
 
-                        // attempt allocation 
-                        void* n = alloc(sz);
-                        if(n == nullptr)
-                        {
-                            // un-free the block
-                            if(block == free_head) {
-                                free_head = (Block*)block->head.next;
-                                if(free_head != nullptr) {
-                                    free_head->head.prev = block->head.prev;
-                                }
-                            }
-                            else {
-                                if(block->head.next != nullptr) {
-                                    reinterpret_cast<Block*>(block->head.next)->head.prev = block->head.prev;
-                                }
-                                if(block->head.prev != nullptr) {
-                                    reinterpret_cast<Block*>(block->head.prev)->head.next = block->head.next;
-                                }
-                            }
-
-                            block->head.ref = 1;
-
-                            return nullptr;
-                        }
-                        // copy contents of the old chunks to the new location
-                        memmove(n, ptr, old_chunks*CHUNK_SIZE);
-                        return n;
-                    }
+                uint32 n_chunks = chunks_for(sz);
+                Block* run = nullptr;
+                if(n <= TOTAL_CHUNKS/n_chunks) {
+                    run = take_free_block(n_chunks*n);
                 }
-                // the allocation is fine
-                else 
+                if(run == nullptr) {
+                    return Pool::alloc_n(out, sz, n);
+                }
+
+                uint32 t = trace_begin();
+                Block* block = run;
+                for(uint32 i = 0; i < n; i++)
                 {
-                    return ptr;
+                    if(i > 0) {
+                        block->head.prev_free = 0;
+                    }
+                    block->head.size = n_chunks;
+                    block->head.ref = 1;
+                    block->head.used = sz;
+                    out[i] = (void*)&block->bytes[sizeof(BlockHead)];
+                    block += n_chunks;
                 }
+                update_next_tag(block - n_chunks);
+
+                note_alloc(out[0]);
+                trace_end(AllocTrace::ALLOC_N, t, sz, n_chunks*n);
+                return true;
             }
-            /*}}}*/
 
-            /* 
-             * free releases a block of memory back to the memory pool.
+            /**
+             * free_n releases n blocks. Blocks that sit next to each other in
+             * memory, such as a batch from alloc_n, are joined and released 
+             * together.
              */
-            void free(void* ptr)/*{{{*/
+            void free_n(void** ptrs, uint32 n)
             {
-                if(ptr != nullptr) 
+                uint32 t = trace_begin();
+                uint32 chunks = 0;
+                Block* run = nullptr;
+                for(uint32 i = 0; i < n; i++)
                 {
-                    // freeing a block adds it to the tail
-                    uint8* bptr = (uint8*)ptr;
-                    bptr -= sizeof(BlockHead);
-                    Block* block = (Block*)bptr;
+                    if(ptrs[i] == nullptr) {
+                        continue;
+                    }
 
-                    if(free_head != nullptr)
+                    Block* block = block_of(ptrs[i]);
+                    chunks += block->head.size;
+                    if((run != nullptr) && (next_block(run) == block)) 
                     {
-                        free_head->head.prev = block;
+                        run->head.size += block->head.size;
                     }
-                    block->head.next = free_head;
-                    block->head.prev = nullptr;
-                    block->head.ref = 0;
+                    else 
+                    {
+                        if(run != nullptr) {
+                            release(run);
+                        }
+                        run = block;
+                    }
+                }
 
-                    free_head = block;
+                if(run != nullptr) {
+                    release(run);
                 }
-            }/*}}}*/
+                trace_end(AllocTrace::FREE_N, t, chunks*CHUNK_SIZE, chunks);
+            }
 
             uint32 ref(void* ptr)
             {
                 if(ptr != nullptr) 
                 {
-                    // freeing a block adds it to the tail
-                    uint8* bptr = (uint8*)ptr;
-                    bptr -= sizeof(BlockHead);
-                    Block* block = (Block*)bptr;
+                    Block* block = block_of(ptr);
                     block->head.ref++;
                     return block->head.ref;
                 }
@@ -255,25 +361,16 @@ namespace etk
             {
                 if(ptr != nullptr) 
                 {
-                    // freeing a block adds it to the tail
-                    //
-
-                    uint8* bptr = (uint8*)ptr;
-                    bptr -= sizeof(BlockHead);
-                    Block* block = (Block*)bptr;
+                    Block* block = block_of(ptr);
                     if(block->head.ref > 0) {
                         block->head.ref--;
 
                         if(block->head.ref == 0) {
-                            if(free_head != nullptr)
-                            {
-                                free_head->head.prev = block;
-                            }
-                            block->head.next = free_head;
-                            block->head.prev = nullptr;
-                            block->head.ref = 0;
-
-                            free_head = block;
+                            uint32 t = trace_begin();
+                            uint32 chunks = block->head.size;
+                            release(block);
+                            trace_end(AllocTrace::FREE, t, chunks*CHUNK_SIZE, chunks);
+                            return 0;
                         }
                         return block->head.ref;
                     }
@@ -284,6 +381,8 @@ namespace etk
 
             /**
              * Joins adjacent free blocks together.
+             * Blocks are merged when they are freed so this should never find
+             * anything to join. It returns the number of free blocks.
              */
             uint32 coalesce()
             {
@@ -308,13 +407,82 @@ namespace etk
                 return free_head - blocks;
             }
 
+            /**
+             * Starts recording every alloc, free and realloc into buf. Pass
+             * nullptr to stop. The buffer overwrites the oldest records when
+             * it is full, so it holds the most recent history.
+             *
+             * clock is optional and should return a free running tick count,
+             * such as a cycle counter. Latencies are recorded in its ticks.
+             */
+            void set_trace(RingBuffer<AllocTrace, true>* buf, uint32 (*clock)() = nullptr)
+            {
+                trace_buf = buf;
+                trace_clock = clock;
+            }
+
+            /**
+             * Walks the blocks and reports how the free memory is split up.
+             */
+            FragmentationReport fragmentation_report()
+            {
+                FragmentationReport rep;
+                memset(&rep, 0, sizeof(rep));
+
+                uint32 i = 0;
+                while(i < TOTAL_CHUNKS)
+                {
+                    uint32 size = blocks[i].head.size;
+                    if(block_is_free(&blocks[i]))
+                    {
+                        rep.free_chunks += size;
+                        rep.free_runs++;
+                        rep.largest_free_run = max(rep.largest_free_run, size);
+
+                        uint32 bucket = 0;
+                        while(((size >> 1) > 0) && (bucket < FragmentationReport::N_BUCKETS - 1))
+                        {
+                            size >>= 1;
+                            bucket++;
+                        }
+                        rep.histogram[bucket]++;
+                    }
+                    i += blocks[i].head.size;
+                }
+
+                if(rep.free_chunks > 0) {
+                    rep.external_fragmentation = 1.0 - 
+                        (real_t)rep.largest_free_run/(real_t)rep.free_chunks;
+                }
+                return rep;
+            }
+
+#ifndef ETK_NO_POOL_STATS
+            /**
+             * Returns the occupancy counters of the pool, in chunks.
+             */
+            PoolStats stats() const
+            {
+                PoolStats st;
+                st.capacity = TOTAL_CHUNKS;
+                st.free = n_free;
+                st.high_water = high_water;
+                st.failed_allocs = failed_allocs;
+                return st;
+            }
+#endif
+
         private:
             static const uint32 TOTAL_CHUNKS = SIZE/CHUNK_SIZE;
 
             struct BlockHead {
-                uint32 size;
+                uint32 size : 31;
+                uint32 prev_free : 1; // the block physically before this one is free
                 uint32 ref;
-                void* next;
+                union {
+                    void* next;       // free list link, while the block is free
+                    uint32 used;      // bytes requested, while the block is allocated
+                };
                 void* prev;
             };
 
@@ -330,6 +498,287 @@ namespace etk
             static_assert(sizeof(Block) == CHUNK_SIZE, "Block does not equal chunk size");
 
 
+            static uint32 chunks_for(uint32 sz)
+            {
+                uint32 N = sz+sizeof(BlockHead);
+                return N / CHUNK_SIZE + ((N % CHUNK_SIZE != 0) * 1);
+            }
+
+            Block* block_of(void* ptr)
+            {
+                uint8* bptr = (uint8*)ptr;
+                bptr -= sizeof(BlockHead);
+                return (Block*)bptr;
+            }
+
+            /**
+             * Returns the block physically after this one, or nullptr at the 
+             * end of the pool.
+             */
+            Block* next_block(Block* block)
+            {
+                Block* next = block + block->head.size;
+                if(next >= &blocks[TOTAL_CHUNKS]) {
+                    return nullptr;
+                }
+                return next;
+            }
+
+            /**
+             * Returns the block physically before this one if it is free,
+             * otherwise nullptr. Its size is read from the tag at its end.
+             */
+            Block* prev_block(Block* block)
+            {
+                if((block == &blocks[0]) || !block->head.prev_free) {
+                    return nullptr;
+                }
+                uint32 prev_size;
+                memcpy(&prev_size, block[-1].bytes + CHUNK_SIZE - sizeof(uint32), sizeof(uint32));
+                return block - prev_size;
+            }
+
+            /**
+             * Updates the boundary tags after a block has changed size or been
+             * allocated or freed. A free block gets its size written at its 
+             * end, and the following block is told whether this one is free.
+             */
+            void update_next_tag(Block* block)
+            {
+                uint32 size = block->head.size;
+                bool is_free = block_is_free(block);
+                if(is_free) {
+                    memcpy(block[size-1].bytes + CHUNK_SIZE - sizeof(uint32), &size, sizeof(uint32));
+                }
+
+                Block* next = next_block(block);
+                if(next != nullptr) {
+                    next->head.prev_free = is_free;
+                }
+            }
+
+            /**
+             * Adds a block to the head of the free list.
+             */
+            void push_free(Block* block)
+            {
+                if(free_head != nullptr)
+                {
+                    free_head->head.prev = block;
+                }
+                block->head.next = free_head;
+                block->head.prev = nullptr;
+                block->head.ref = 0;
+
+                free_head = block;
+            }
+
+            /**
+             * Removes a block from the free list. The block is marked as in use.
+             */
+            void unlink_free(Block* block)
+            {
+                if(block == free_head) {
+                    free_head = (Block*)block->head.next;
+                }
+                if(block->head.next != nullptr) {
+                    reinterpret_cast<Block*>(block->head.next)->head.prev = block->head.prev;
+                }
+                if(block->head.prev != nullptr) {
+                    reinterpret_cast<Block*>(block->head.prev)->head.next = block->head.next;
+                }
+                block->head.ref = 1;
+            }
+
+            /**
+             * Resizes an allocation. A block that needs to grow first tries to
+             * take in a free block after it, then a free block before it, 
+             * sliding its contents down. Only if neither works is it moved.
+             * The block is never put on the free list until its contents
+             * have been copied, so nothing needs undoing if memory runs out.
+             * Only the bytes that were requested are copied.
+             */
+            void* resize(void* ptr, uint32 sz)
+            {
+                Block* block = block_of(ptr);
+                uint32 old_chunks = block->head.size;
+                uint32 live = min(block->head.used, sz);
+
+                // calculate the number of chunks to allocate
+                uint32 n_chunks = chunks_for(sz);
+
+                //the allocation needs to be shrunk down
+                if(old_chunks > n_chunks)
+                {
+                    split_block(block, n_chunks);
+                    block->head.used = sz;
+                    return ptr;
+                }
+                // the allocation is fine
+                else if(old_chunks == n_chunks)
+                {
+                    block->head.used = sz;
+                    return ptr;
+                }
+
+                //the allocation needs to grow larger
+                Block* next = next_block(block);
+                uint32 next_free = 0;
+                if((next != nullptr) && block_is_free(next)) {
+                    next_free = next->head.size;
+                }
+
+                // grow into the next block, nothing moves
+                if(old_chunks + next_free >= n_chunks)
+                {
+                    take_neighbour(next);
+                    block->head.size += next_free;
+                    update_next_tag(block);
+                    if(block->head.size > n_chunks) {
+                        split_block(block, n_chunks);
+                    }
+                    block->head.used = sz;
+                    note_alloc(ptr);
+                    return ptr;
+                }
+
+                Block* prev = prev_block(block);
+                uint32 prev_free = 0;
+                if((prev != nullptr) && block_is_free(prev)) {
+                    prev_free = prev->head.size;
+                }
+
+                // grow into the previous block (and the next one if needed) 
+                // and slide the contents down
+                if(prev_free + old_chunks + next_free >= n_chunks)
+                {
+                    uint32 ref = block->head.ref;
+                    take_neighbour(prev);
+                    if(next_free > 0) {
+                        take_neighbour(next);
+                    }
+                    prev->head.size = prev_free + old_chunks + next_free;
+                    update_next_tag(prev);
+
+                    // the old header may be overwritten by the move
+                    void* n = (void*)&prev->bytes[sizeof(BlockHead)];
+                    memmove(n, ptr, live);
+                    prev->head.ref = ref;
+                    if(prev->head.size > n_chunks) {
+                        split_block(prev, n_chunks);
+                    }
+                    prev->head.used = sz;
+                    note_alloc(n);
+                    return n;
+                }
+
+                // worst case scenario, move it somewhere else
+                void* n = alloc_from_free_list(sz);
+                note_alloc(n);
+                if(n == nullptr)
+                {
+                    return nullptr;
+                }
+                memcpy(n, ptr, live);
+                block_of(n)->head.ref = block->head.ref;
+                release(block);
+                return n;
+            }
+
+            /**
+             * Removes a free neighbour from the free list so that an allocated
+             * block can take it in.
+             */
+            void take_neighbour(Block* block)
+            {
+                if(block == nullptr) {
+                    return;
+                }
+                unlink_free(block);
+#ifndef ETK_NO_POOL_STATS
+                n_free -= block->head.size;
+#endif
+            }
+
+            /**
+             * Returns the start time of a traced operation.
+             */
+            uint32 trace_begin()
+            {
+                if((trace_buf != nullptr) && (trace_clock != nullptr)) {
+                    return trace_clock();
+                }
+                return 0;
+            }
+
+            void trace_end(AllocTrace::Op op, uint32 start, uint32 size, uint32 chunks, bool ok = true)
+            {
+                if(trace_buf != nullptr)
+                {
+                    AllocTrace rec;
+                    rec.op = op;
+                    rec.ok = ok;
+                    rec.size = size;
+                    rec.chunks = chunks;
+                    rec.latency = (trace_clock != nullptr) ? trace_clock() - start : 0;
+                    trace_buf->put(rec);
+                }
+            }
+
+            void trace_end(AllocTrace::Op op, uint32 start, uint32 size, void* r)
+            {
+                if(trace_buf != nullptr)
+                {
+                    uint32 chunks = (r != nullptr) ? block_of(r)->head.size : chunks_for(size);
+                    trace_end(op, start, size, chunks, r != nullptr);
+                }
+            }
+
+            /**
+             * Updates the counters after an allocation or a realloc that grew.
+             */
+            void note_alloc(void* r)
+            {
+#ifndef ETK_NO_POOL_STATS
+                if(r == nullptr) {
+                    failed_allocs++;
+                }
+                else if(TOTAL_CHUNKS - n_free > high_water) {
+                    high_water = TOTAL_CHUNKS - n_free;
+                }
+#else
+                (void)(r);
+#endif
+            }
+
+            /**
+             * Returns a block to the pool, merging it with free neighbours on 
+             * either side.
+             */
+            void release(Block* block)
+            {
+#ifndef ETK_NO_POOL_STATS
+                n_free += block->head.size;
+#endif
+                Block* next = next_block(block);
+                if((next != nullptr) && block_is_free(next))
+                {
+                    unlink_free(next);
+                    block->head.size += next->head.size;
+                }
+
+                Block* prev = prev_block(block);
+                if((prev != nullptr) && block_is_free(prev))
+                {
+                    unlink_free(prev);
+                    prev->head.size += block->head.size;
+                    block = prev;
+                }
+
+                push_free(block);
+                update_next_tag(block);
+            }
+
             void join_adjacent(uint32 block_n) 
             {
                 uint32 first = block_n;
@@ -339,53 +788,32 @@ namespace etk
                 }
 
                 uint32 count = block_n;
-                while((block_is_free(&blocks[block_n])) && 
+                while((block_n < TOTAL_CHUNKS) && 
+                        (block_is_free(&blocks[block_n])) && 
                         (count < TOTAL_CHUNKS)) {
                     blocks[first].head.size += blocks[block_n].head.size;
                     count += blocks[block_n].head.size;
 
-                    if(&blocks[block_n] == free_head) {
-                        free_head = (Block*)blocks[block_n].head.next;
-                        blocks[block_n].head.prev = nullptr;
-                    }
-
                     //remove the block from the free block list - cause it's not free no more
-                    if(blocks[block_n].head.next != nullptr) {
-                        reinterpret_cast<Block*>(
-                                blocks[block_n].head.next)->head.prev =
-                            blocks[block_n].head.prev;
-                    }
-                    if(blocks[block_n].head.prev != nullptr) {
-                        reinterpret_cast<Block*>(
-                                blocks[block_n].head.prev)->head.next = 
-                            blocks[block_n].head.next;
-                    }
-
-                    //memset(blocks[block_n].bytes, 0, sizeof(Block));
-                    blocks[block_n].head.ref = 1;
+                    unlink_free(&blocks[block_n]);
 
                     block_n += blocks[block_n].head.size;
                 }
+                update_next_tag(&blocks[first]);
             }
 
             /**
              * split_block splits a large chunk into two smaller chunks 
-             * and adds the second chunk to the free list.
+             * and releases the second chunk back to the pool.
              */
             void split_block(Block* n, uint32 split_pos) {
                 Block* sp = &n[split_pos];
 
-                if(free_head != nullptr) 
-                {
-                    free_head->head.prev = sp;
-                }
                 sp->head.size = n->head.size-split_pos;
-                sp->head.next = free_head;
-                sp->head.prev = nullptr;
-                sp->head.ref = 0;
-                free_head = sp;
-
+                sp->head.prev_free = 0;
                 n->head.size = split_pos;
+
+                release(sp);
             }
 
 
@@ -394,10 +822,21 @@ namespace etk
              */
             void* alloc_from_free_list(uint32 sz)
             {
-                // calculate the number of blocks to allocate
-                uint32 N = sz+sizeof(BlockHead);
-                uint32 n_blocks = N / CHUNK_SIZE + ((N % CHUNK_SIZE != 0) * 1) ;
+                Block* n = take_free_block(chunks_for(sz));
+                if(n == nullptr) {
+                    return nullptr;
+                }
+                n->head.used = sz;
+                //return a pointer to the start of the allocated chunk
+                return (void*)&n->bytes[sizeof(BlockHead)];
+            }
 
+            /**
+             * Finds a free block of at least n_blocks chunks, removes it from 
+             * the free list and splits off anything left over.
+             */
+            Block* take_free_block(uint32 n_blocks)
+            {
                 // iterate over the free blocks
                 Block* n = free_head;
                 uint32 count = 0;
@@ -407,6 +846,12 @@ namespace etk
                     //if this block has sufficient space
                     if(n->head.size >= n_blocks)
                     {
+                        //remove the block from the free block list - cause it's not free no more
+                        unlink_free(n);
+#ifndef ETK_NO_POOL_STATS
+                        n_free -= n->head.size;
+#endif
+
                         //if the block is too big, split it
                         if(n->head.size > n_blocks)
                         {
@@ -414,28 +859,9 @@ namespace etk
                             split_block(n, n_blocks);
                         }
 
-                        // if the free head is being allocated
-                        if(n == free_head) {
-                            // move the free head to the next free chunk
-                            free_head = (Block*)n->head.next;
-                            // link the next chunk to the prior chunk
-                            if(free_head != nullptr) {
-                                free_head->head.prev = n->head.prev;
-                            }
-                        }
-                        else {
-                            //remove the block from the free block list - cause it's not free no more
-                            if(n->head.next != nullptr) {
-                                reinterpret_cast<Block*>(n->head.next)->head.prev = n->head.prev;
-                            }
-                            if(n->head.prev != nullptr) {
-                                reinterpret_cast<Block*>(n->head.prev)->head.next = n->head.next;
-                            }
-                        }
-
                         n->head.ref = 1;
-                        //return a pointer to the start of the allocated chunk
-                        return (void*)&n->bytes[sizeof(BlockHead)];
+                        update_next_tag(n);
+                        return n;
                     }
                     n = (Block*)n->head.next;
                 }
@@ -453,6 +879,13 @@ namespace etk
             }
 
             Block* free_head;
+            RingBuffer<AllocTrace, true>* trace_buf;
+            uint32 (*trace_clock)();
+#ifndef ETK_NO_POOL_STATS
+            uint32 n_free;
+            uint32 high_water;
+            uint32 failed_allocs;
+#endif
             Block blocks[TOTAL_CHUNKS];
     };
 }
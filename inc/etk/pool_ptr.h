@@ -23,12 +23,13 @@ p_obj->foo();
 #include <utility>
 
 #include "pool.h"
+#include "relocate.h"
 
 namespace etk
 {
 
 
-    template <typename T> class pool_pointer
+    template <typename T, typename POOL = Pool> class pool_pointer
     {
 
         public:
@@ -37,48 +38,75 @@ namespace etk
              *
              * auto p = etk::pool_pointer<MyClass>::make(pool, <constructor params>);
              *
+             * Naming the pool type lets the compiler call the pool directly. 
+             *
+             * auto p = etk::pool_pointer<MyClass, MemPool<1024>>::make(pool, ...);
              */
-            template<class... U> static pool_pointer<T> make(Pool& pool, U&&... u);
+            template<class... U> static pool_pointer<T, POOL> make(POOL& pool, U&&... u);
 
 
             /**
              * copy constructor
              */
-            pool_pointer(const pool_pointer<T>& sp) 
+            pool_pointer(const pool_pointer<T, POOL>& sp) 
+                : pool(sp.pool), o(sp.o)
+            {
+                pool->ref(o);
+            }
+
+            /**
+             * move constructor. takes the reference without touching the count.
+             */
+            pool_pointer(pool_pointer<T, POOL>&& sp) 
+                : pool(sp.pool), o(sp.o)
             {
-                pool.ref(o);
+                sp.o = nullptr;
             }
 
             ~pool_pointer()
             {
-                pool.free(o);
+                release();
             }
 
             T& operator* ()
             {
-                return o;
+                return *o;
             }
 
             T* operator-> ()
             {
-                return &o;
+                return o;
             }
 
             /**
              * assignment operator
              */
-            pool_pointer<T>& operator = (const pool_pointer<T>& sp)
+            pool_pointer<T, POOL>& operator = (const pool_pointer<T, POOL>& sp)
             {
                 // if not assigning to itself
                 if (this != &sp)
                 {
                     // deref self
-                    pool.unref(o);
+                    release();
 
                     //get other obj
+                    pool = sp.pool;
                     o = sp.o;
                     //inc reference
-                    pool.ref(o);
+                    pool->ref(o);
+                }
+                return *this;
+            }
+
+            pool_pointer<T, POOL>& operator = (pool_pointer<T, POOL>&& sp)
+            {
+                if (this != &sp)
+                {
+                    release();
+
+                    pool = sp.pool;
+                    o = sp.o;
+                    sp.o = nullptr;
                 }
                 return *this;
             }
@@ -86,12 +114,12 @@ namespace etk
             /**
              * comparison operators
              */
-            bool operator == (const pool_pointer<T>& sp)
+            bool operator == (const pool_pointer<T, POOL>& sp)
             {
                 return o == sp.o;
             }
 
-            bool operator != (const pool_pointer<T>& sp)
+            bool operator != (const pool_pointer<T, POOL>& sp)
             {
                 return o != sp.o;
             }
@@ -103,32 +131,62 @@ namespace etk
             }
 
             // gets a reference to the pool
-            Pool& get_pool()
+            POOL& get_pool()
             {
-                return pool;
+                return *pool;
             }
 
 
         private:
-            pool_pointer() { }
-
-            pool_pointer(Pool& pool, T* o) 
-                : pool(pool), o(o)
+            pool_pointer(POOL& pool, T* o) 
+                : pool(&pool), o(o)
             { 
             }
 
+            /**
+             * Drops this reference. The object is destroyed by the last one.
+             */
+            void release()
+            {
+                if(o != nullptr)
+                {
+                    // make() holds one extra reference, so the count reaches 
+                    // one when the last pointer lets go. the object is destroyed
+                    // before the pool frees the memory at zero
+                    if(pool->unref(o) == 1) {
+                        o->~T();
+                        pool->unref(o);
+                    }
+                    o = nullptr;
+                }
+            }
+
+            POOL* pool;
             T* o = nullptr;
-            Pool& pool;
     };
 
-    template <typename T> template<class... U> pool_pointer<T> pool_pointer<T>::make(Pool& pool, U&&... u) {
-        auto* ptr = (T*)pool.alloc(sizeof(T)); 
-
-        new(&ptr->o) T(std::forward<U>(u)...);
+    template <typename T, typename POOL> template<class... U> 
+        pool_pointer<T, POOL> pool_pointer<T, POOL>::make(POOL& pool, U&&... u) 
+    {
+        T* ptr = (T*)pool.alloc(sizeof(T)); 
+        if(ptr != nullptr) {
+            new(ptr) T(std::forward<U>(u)...);
+            pool.ref(ptr);
+        }
 
-        pool_pointer<T> sp(pool, ptr);
+        pool_pointer<T, POOL> sp(pool, ptr);
         return sp;
     }
+
+    /**
+     * A pool pointer only holds the address of the object, so moving its 
+     * bytes is the same as moving it. Lists of pool pointers can be resized 
+     * without any reference counting.
+     */
+    template <typename T, typename POOL> struct is_trivially_relocatable<pool_pointer<T, POOL>>
+    {
+        static const bool value = true;
+    };
 }
 
 #endif
@@ -0,0 +1,85 @@
+/*
+   Embedded Tool Kit
+   Copyright (C) 2015 Samuel Cowen
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_RELOCATE_H_INCLUDED
+#define ETK_RELOCATE_H_INCLUDED
+
+// AVR has no <new>. list.h and dynamic_list.h define placement new for it
+// before including this file.
+#ifndef __AVR__
+#include <new>
+#endif
+
+#include <string.h>
+#include "types.h"
+
+
+namespace etk
+{
+
+    /**
+     * \brief Says whether objects of type T can be moved to a new address by
+     * copying their bytes.
+     *
+     * This is true for trivially copyable types. Types that own memory but
+     * don't point into themselves (e.g. pool_pointer) can specialise it to
+     * make containers of them grow with memmove instead of a move and destroy
+     * per element.
+     */
+    template <typename T> struct is_trivially_relocatable
+    {
+        static const bool value = __is_trivially_copyable(T);
+    };
+
+
+    /**
+     * \brief Moves n objects from src to dst and ends the lifetime of the
+     * objects at src. The ranges may overlap.
+     */
+    template <typename T> void relocate(T* dst, T* src, uint32 n)
+    {
+        if((dst == src) || (n == 0)) {
+            return;
+        }
+
+        if(is_trivially_relocatable<T>::value)
+        {
+            memmove((void*)dst, (void*)src, sizeof(T)*n);
+            return;
+        }
+
+        // walk in the direction that never overwrites an object before it
+        // has been moved
+        if(dst < src)
+        {
+            for(uint32 i = 0; i < n; i++)
+            {
+                new(&dst[i]) T(static_cast<T&&>(src[i]));
+                src[i].~T();
+            }
+        }
+        else
+        {
+            for(uint32 i = n; i > 0; i--)
+            {
+                new(&dst[i-1]) T(static_cast<T&&>(src[i-1]));
+                src[i-1].~T();
+            }
+        }
+    }
+
+}
+
+#endif
@@ -21,6 +21,30 @@
 namespace etk
 {
 
+/**
+ * \brief Up to two runs of items that sit in a ring buffer's memory.
+ *
+ * Data that wraps past the end of the buffer is split in two. The first run
+ * always comes first in the stream. second_len is zero when the data does
+ * not wrap.
+ */
+template <class T> struct RingSpans
+{
+    T* first;
+    uint32 first_len;
+    T* second;
+    uint32 second_len;
+
+    /**
+     * \brief Returns the total number of items in both runs.
+     */
+    uint32 size() const
+    {
+        return first_len + second_len;
+    }
+};
+
+
 /**
  * \class RingBuffer
  *
@@ -43,12 +67,24 @@ namespace etk
          Usart.put(ringbuf.get());
  }
  @endcode
+ *
+ * read_spans() and write_spans() give direct access to the buffer memory, so
+ * a parser or a DMA transfer can work on the data without copying it out
+ * first. Call consume() or commit() once the items have been used.
+ * @code
+ etk::RingSpans<char> s = ringbuf.read_spans();
+ crc = crc_update(crc, s.first, s.first_len);
+ crc = crc_update(crc, s.second, s.second_len);
+ ringbuf.consume(s.size());
+ @endcode
  * @tparam T type of object that is being buffered. For a UART this would typically be a char or uint8.
  * @tparam overwrite If overriden to true, the ring buffer will write over data when it becomes full.
+ * @tparam IDX The type used for positions and sizes. The default suits small MCUs; use uint32 for buffers
+ * of more than 65535 items.
  */
 
 
-template <class T, bool overwrite = false> class RingBuffer
+template <class T, bool overwrite = false, typename IDX = uint16> class RingBuffer
 {
 public:
     /**
@@ -56,7 +92,7 @@ public:
      * @arg buffer Pointer to a writeable memory location.
      * @arg sz Maximum number of items that can be stored before the buffer is full.
      */
-    RingBuffer(T* buffer, uint16 sz)
+    RingBuffer(T* buffer, IDX sz)
     {
         size = sz;
         start = 0;
@@ -75,9 +111,11 @@ public:
     /**
      * \brief Returns the number of items queued up in the RingBuffer.
      */
-    uint16 available()
+    IDX available()
     {
-        return (uint16)(size + end - start) % size;
+        if(end >= start)
+            return end - start;
+        return size - start + end;
     }
 
     /**
@@ -85,10 +123,12 @@ public:
      */
     void put(T b)
     {
-        if(!overwrite)
+        if(is_full())
         {
-            if(is_full())
+            if(!overwrite)
                 return;
+            // drop the oldest item to make room
+            start = (start + 1) % size;
         }
         buf[end] = b;
         end = (end + 1) % size;
@@ -115,12 +155,79 @@ public:
     /**
      * \brief Returns the next item from the buffer without actually removing it.
      */
-    T peek_ahead(uint16 n=0)
+    T peek_ahead(IDX n=0)
     {
-        uint16 pos = (start+n) % size;
+        IDX pos = (start+n) % size;
         return buf[pos];
     }
 
+    /**
+     * \brief Returns the items that are ready to be read, without removing them.
+     */
+    RingSpans<T> read_spans()
+    {
+        RingSpans<T> s;
+        s.first = &buf[start];
+        s.second = &buf[0];
+        if(end >= start)
+        {
+            s.first_len = end - start;
+            s.second_len = 0;
+        }
+        else
+        {
+            s.first_len = size - start;
+            s.second_len = end;
+        }
+        return s;
+    }
+
+    /**
+     * \brief Removes n items from the front of the buffer. Use after read_spans().
+     */
+    void consume(IDX n)
+    {
+        if(n > available())
+            n = available();
+        start = (IDX)((start + n) % size);
+    }
+
+    /**
+     * \brief Returns the free space that items can be written in to.
+     * The items are not part of the buffer until commit() is called.
+     */
+    RingSpans<T> write_spans()
+    {
+        // one slot is always left empty so that a full buffer can be told
+        // apart from an empty one
+        IDX last = (start == 0) ? size - 1 : start - 1;
+        RingSpans<T> s;
+        s.first = &buf[end];
+        s.second = &buf[0];
+        if(last >= end)
+        {
+            s.first_len = last - end;
+            s.second_len = 0;
+        }
+        else
+        {
+            s.first_len = size - end;
+            s.second_len = last;
+        }
+        return s;
+    }
+
+    /**
+     * \brief Adds n items that were written through write_spans() to the end of the buffer.
+     */
+    void commit(IDX n)
+    {
+        IDX space = size - 1 - available();
+        if(n > space)
+            n = space;
+        end = (IDX)((end + n) % size);
+    }
+
     /**
      * \brief Makes the start and end of the ring buffer equal zero so that available() return zero.
      */
@@ -131,9 +238,9 @@ public:
     }
 
 private:
-    uint16 size;
-    uint16 start;
-    uint16 end;
+    IDX size;
+    IDX start;
+    IDX end;
     T* buf;
 };
 
@@ -18,6 +18,8 @@
 
 #include "types.h"
 #include "math_util.h"
+#include "format.h"
+#include "parse.h"
 
 
 namespace etk
@@ -92,125 +94,45 @@ public:
         str[pos] = '\0';
     }
 
-    //void append(int i, uint32 npad = 1);
-    //void append(unsigned int i, uint32 npad = 1);
     void append(int32 j, uint32 npad = 1)
     {
-        if(j < 0)
-        {
-            if(j == -2147483648) //special case for j == min int32
-            {
-                append("-2147483648");
-                return;
-            }
-            append('-');
-            j *= -1;
-        }
-        append((uint32)j, npad);
-        terminate();
+        char buf[FORMAT_BUFFER_SIZE];
+        append(buf, format_int(buf, j, npad));
     }
 
     void append(uint32 j, uint32 npad = 1)
     {
-        char buf[12];
-        uint32 i = 0;
-        for(i = 0; i < 12; i++)
-        {
-            int r = j%10;
-            j /= 10;
-            buf[11-i] = '0'+static_cast<char>(r);
-        }
-        i = 0;
-        while(i < 12)
-        {
-            if(buf[i] != '0')
-                break;
-            i++;
-        }
-        i = min(i, 12-npad);
-        append(&buf[i], 12-i);
-        terminate();
+        char buf[FORMAT_BUFFER_SIZE];
+        append(buf, format_uint(buf, j, npad));
     }
 
     void append(int64 j, uint32 npad = 1)
     {
-        if(j < 0)
-        {
-            if(j == (-9223372036854775807-1))
-            {
-                append("–922337203685477808");
-                return;
-            }
-            append('-');
-            j *= -1;
-        }
-        append((uint64)j, npad);
-        terminate();
+        char buf[FORMAT_BUFFER_SIZE];
+        append(buf, format_int(buf, j, npad));
     }
 
-
     void append(uint64 j, uint32 npad = 1)
     {
-        char buf[60];
-        uint32 i = 0;
-        for(i = 0; i < 60; i++)
-        {
-            int r = j%10;
-            j /= 10;
-            buf[59-i] = '0'+static_cast<char>(r);
-        }
-        i = 0;
-        while(i < 60)
-        {
-            if(buf[i] != '0')
-                break;
-            i++;
-        }
-        i = min(i, 60-npad);
-        append(&buf[i], 60-i);
-        terminate();
+        char buf[FORMAT_BUFFER_SIZE];
+        append(buf, format_uint(buf, j, npad));
     }
 
-    void append(float j, uint8 precision = 2) //precision cannot be more than 15
+    /**
+     * \brief Appends a float with precision digits after the decimal point.
+     * Precision cannot be more than 15. Passing etk::SHORTEST appends the
+     * fewest digits that read back as the same float.
+     */
+    void append(float j, uint8 precision = 2)
     {
-		if(isnan(j))
-		{
-		    append("nan", 3);
-		    return;
-		}
-		if(isinf(j))
-		{
-		    append("inf", 3);
-		    return;
-		}
-
-		precision &= 0x0F;
-
-		uint64 mul = static_cast<uint64>(pow(10, precision));
-
-		float r = j*mul;
-		const int64 max_int64 = 9223372036854775807;
-		if(r >= max_int64)
-		{
-			append("ovr", 3);
-			return;
-		}
+        char buf[FORMAT_BUFFER_SIZE];
+        append(buf, format_float(buf, j, precision));
+    }
 
-		int64 t = static_cast<int64>(roundf(r));
-		char b[20];
-		Rope sb(b, 20);
-		sb.clear();
-		sb.append(t, static_cast<uint32>(precision)+1);
-		uint64 len = max((int)sb.length()-precision, 0);
-		append(sb.c_str(), len);
-		append('.');
-		append(&sb.c_str()[len], sb.length()-len);
-		terminate();
-	}
-	
     void append(double d, uint8 precision = 2) //precision cannot be more than 15
     {
-        append(static_cast<float>(d), precision);
+        char buf[FORMAT_BUFFER_SIZE];
+        append(buf, format_float(buf, d, precision));
     }
 
     void append(Rope sb, uint16 len = 0)
@@ -510,56 +432,26 @@ public:
 
     int atoi(const uint32 p=0) const
     {
-        int res = 0,n=1;
-        char* pstr = &str[p];
-        if(*pstr =='-')
-        {
-            n=-1;
-            pstr++;
-        }
-        while (is_numeric(*pstr))
-            res = res * 10 + *pstr++ - '0';
-        return res*n;
+        int32 res = 0;
+        parse_number(&str[p], &str[N], res);
+        return res;
     }
 
-    float atof(const uint32 ps=0) const
+    float atof(const uint32 p=0) const
     {
-		if(compare("nan", 3))
-		    return NAN;
-		if(compare("inf", 3))
-		    return INFINITY;
-
-		char* p = &str[ps];
-		real_t sign = 0;
-        real_t value = 0;
-
-		sign = 1.0;
-		if (*p == '-')
-		{
-		    sign = -1.0;
-		    p++;
-		}
-		else if (*p == '+')
-		    p++;
-
-		for (value = 0.0; is_numeric(*p); p++)
-		    value = value * real_t(10.0) + (*p - '0');
+        float res = 0;
+        parse_number(&str[p], &str[N], res);
+        return res;
+    }
 
-		// Get digits after decimal point, if any.
-		if (*p == '.')
-		{
-		    float pow10 = 10.0;
-		    p++;
-		    while ((*p >= '0') && (*p <= '9'))
-		    {
-		        value += (*p - '0') / pow10;
-		        pow10 *= 10.0;
-		        p++;
-		    }
-		}
-		// Return signed and scaled floating point result.
-		return sign * value;
-	}
+    /**
+     * \brief Parses a number starting at position p, like etk::parse_number.
+     * The result says where the number ended and if anything went wrong.
+     */
+    template <typename T> ParseResult parse(T& value, const uint32 p=0) const
+    {
+        return parse_number(&str[p], &str[N], value);
+    }
 
     void set_cursor(uint32 p) 
    {
@@ -0,0 +1,329 @@
+/*
+    Embedded Tool Kit
+    Copyright (C) 2015 Samuel Cowen
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+*/
+
+#ifndef ETK_SPSC_RING_BUFFER_H
+#define ETK_SPSC_RING_BUFFER_H
+
+#ifndef __AVR__
+
+#include <atomic>
+#include <string.h>
+#include "types.h"
+#include "ring_buffer.h"
+
+namespace etk
+{
+    /*
+    SpscRingBuffer is a lock-free RingBuffer for one producer thread and one
+    consumer thread.
+
+    Like RingBuffer it stores items in memory that it is given. The number of
+    items it holds is rounded down to a power of two so that positions are
+    found with a mask instead of a modulo, and every slot can be used.
+
+    The producer owns the head index and the consumer owns the tail. Each side
+    publishes its index with a release store and reads the other side's with an
+    acquire load, so an item is always written before the consumer can see it
+    and read before the producer can reuse its slot. The indices live on
+    separate cache lines, and each side keeps its own copy of the other's index
+    so that it only reads the shared one when the buffer looks full or empty.
+
+    put(), put_n(), write_spans(), commit() and is_full() must only be called
+    by the producer. get(), get_n(), peek(), read_spans(), consume() and
+    is_empty() must only be called by the consumer.
+
+    @code
+    uint8 uart_buffer[1024];
+    etk::SpscRingBuffer<uint8> rx(uart_buffer, 1024);
+
+    void reader_thread()
+    {
+        uint8 tmp[64];
+        uint32 n = uart_read(tmp, 64);
+        rx.put_n(tmp, n);
+    }
+
+    void parser_thread()
+    {
+        uint8 line[64];
+        uint32 n = rx.get_n(line, 64);
+        ...
+    }
+    @endcode
+
+    T = type of object that is being buffered. put_n() and get_n() copy
+        with memcpy, so they need a trivially copyable T.
+    */
+    template <class T> class SpscRingBuffer
+    {
+        public:
+            /**
+             * \brief The constructor.
+             * @arg buffer Pointer to a writeable memory location.
+             * @arg sz Number of items the memory can hold. Only the largest
+             * power of two that fits is used.
+             */
+            SpscRingBuffer(T* buffer, uint32 sz)
+            {
+                uint32 n = 1;
+                while((n <= sz/2) && (n < 0x80000000)) {
+                    n <<= 1;
+                }
+
+                buf = buffer;
+                mask = n - 1;
+                head.store(0, std::memory_order_relaxed);
+                tail.store(0, std::memory_order_relaxed);
+                head_cache = 0;
+                tail_cache = 0;
+            }
+
+            /**
+             * \brief Returns the number of items the buffer can hold.
+             */
+            uint32 capacity() const
+            {
+                return mask + 1;
+            }
+
+            /**
+             * \brief Returns the number of items queued up. This is only
+             * exact when the other thread is not using the buffer.
+             */
+            uint32 available() const
+            {
+                return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+            }
+
+            /**
+             * \brief Producer. Returns true when there is no room for another item.
+             */
+            bool is_full()
+            {
+                return free_space() == 0;
+            }
+
+            /**
+             * \brief Consumer. Returns true when there is nothing to read.
+             */
+            bool is_empty()
+            {
+                return readable() == 0;
+            }
+
+            /**
+             * \brief Producer. Puts an item on to the buffer.
+             * \Returns false if the buffer was full.
+             */
+            bool put(const T& t)
+            {
+                if(free_space() == 0) {
+                    return false;
+                }
+
+                uint32 h = head.load(std::memory_order_relaxed);
+                buf[h & mask] = t;
+                head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * \brief Producer. Puts up to n items on to the buffer.
+             * \Returns the number of items that fitted.
+             */
+            uint32 put_n(const T* items, uint32 n)
+            {
+                static_assert(__is_trivially_copyable(T), "put_n() needs a trivially copyable type.");
+
+                uint32 space = free_space(n);
+                if(n > space) {
+                    n = space;
+                }
+
+                uint32 h = head.load(std::memory_order_relaxed);
+                uint32 pos = h & mask;
+                uint32 first = capacity() - pos;
+                if(first > n) {
+                    first = n;
+                }
+                memcpy((void*)&buf[pos], (const void*)items, sizeof(T)*first);
+                memcpy((void*)&buf[0], (const void*)&items[first], sizeof(T)*(n - first));
+
+                head.store(h + n, std::memory_order_release);
+                return n;
+            }
+
+            /**
+             * \brief Consumer. Removes the next item from the buffer.
+             * \Returns false if the buffer was empty.
+             */
+            bool get(T& t)
+            {
+                if(readable() == 0) {
+                    return false;
+                }
+
+                uint32 tl = tail.load(std::memory_order_relaxed);
+                t = buf[tl & mask];
+                tail.store(tl + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * \brief Consumer. Removes up to n items from the buffer.
+             * \Returns the number of items copied to items.
+             */
+            uint32 get_n(T* items, uint32 n)
+            {
+                static_assert(__is_trivially_copyable(T), "get_n() needs a trivially copyable type.");
+
+                uint32 ready = readable(n);
+                if(n > ready) {
+                    n = ready;
+                }
+
+                uint32 tl = tail.load(std::memory_order_relaxed);
+                uint32 pos = tl & mask;
+                uint32 first = capacity() - pos;
+                if(first > n) {
+                    first = n;
+                }
+                memcpy((void*)items, (const void*)&buf[pos], sizeof(T)*first);
+                memcpy((void*)&items[first], (const void*)&buf[0], sizeof(T)*(n - first));
+
+                tail.store(tl + n, std::memory_order_release);
+                return n;
+            }
+
+            /**
+             * \brief Consumer. Copies the nth item without removing it.
+             * \Returns false if there are not that many items.
+             */
+            bool peek(T& t, uint32 n = 0)
+            {
+                if(readable(n + 1) <= n) {
+                    return false;
+                }
+
+                uint32 tl = tail.load(std::memory_order_relaxed);
+                t = buf[(tl + n) & mask];
+                return true;
+            }
+
+            /**
+             * \brief Consumer. Returns the items that are ready to be read,
+             * without removing them. The producer can add more in the meantime
+             * but won't touch these.
+             */
+            RingSpans<T> read_spans()
+            {
+                uint32 ready = readable(capacity());
+                uint32 pos = tail.load(std::memory_order_relaxed) & mask;
+                return spans(pos, ready);
+            }
+
+            /**
+             * \brief Consumer. Removes n items that were read through read_spans().
+             */
+            void consume(uint32 n)
+            {
+                uint32 ready = readable(n);
+                if(n > ready) {
+                    n = ready;
+                }
+                tail.store(tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+            }
+
+            /**
+             * \brief Producer. Returns the free space that items can be written
+             * in to. The consumer can't see them until commit() is called.
+             */
+            RingSpans<T> write_spans()
+            {
+                uint32 space = free_space(capacity());
+                uint32 pos = head.load(std::memory_order_relaxed) & mask;
+                return spans(pos, space);
+            }
+
+            /**
+             * \brief Producer. Publishes n items that were written through write_spans().
+             */
+            void commit(uint32 n)
+            {
+                uint32 space = free_space(n);
+                if(n > space) {
+                    n = space;
+                }
+                head.store(head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+            }
+
+        private:
+            RingSpans<T> spans(uint32 pos, uint32 n)
+            {
+                RingSpans<T> s;
+                s.first = &buf[pos];
+                s.first_len = capacity() - pos;
+                if(s.first_len > n) {
+                    s.first_len = n;
+                }
+                s.second = &buf[0];
+                s.second_len = n - s.first_len;
+                return s;
+            }
+
+            // producer side. only looks at the real tail when there seems to
+            // be less room than wanted
+            uint32 free_space(uint32 wanted = 1)
+            {
+                uint32 h = head.load(std::memory_order_relaxed);
+                uint32 space = capacity() - (h - tail_cache);
+                if(space < wanted)
+                {
+                    tail_cache = tail.load(std::memory_order_acquire);
+                    space = capacity() - (h - tail_cache);
+                }
+                return space;
+            }
+
+            // consumer side. only looks at the real head when there seem to
+            // be fewer items than wanted
+            uint32 readable(uint32 wanted = 1)
+            {
+                uint32 tl = tail.load(std::memory_order_relaxed);
+                uint32 ready = head_cache - tl;
+                if(ready < wanted)
+                {
+                    head_cache = head.load(std::memory_order_acquire);
+                    ready = head_cache - tl;
+                }
+                return ready;
+            }
+
+            // written by the producer
+            alignas(64) std::atomic<uint32> head;
+            uint32 tail_cache;
+
+            // written by the consumer
+            alignas(64) std::atomic<uint32> tail;
+            uint32 head_cache;
+
+            alignas(64) T* buf;
+            uint32 mask;
+    };
+}
+
+#endif
+
+#endif
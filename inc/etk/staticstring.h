@@ -84,6 +84,7 @@ public:
     StaticString()
     {
         buf[0] = '\0';
+        cached_length = 0;
     }
 
     /**
@@ -95,7 +96,7 @@ public:
      */
     StaticString(const char* c)
     {
-        Rope r(buf, L, c);
+        copy_from(c, L);
     }
 
     /**
@@ -103,7 +104,7 @@ public:
      */
     StaticString(Rope r)
     {
-        r.copy(buf);
+        copy_from(r.c_str(), r.length());
     }
 
     /**
@@ -111,7 +112,7 @@ public:
      */
     StaticString& operator = (Rope r)
     {
-        r.copy(buf, L);
+        copy_from(r.c_str(), r.length());
         return *this;
     }
 
@@ -120,15 +121,13 @@ public:
      */
     StaticString& operator = (StaticString& s)
     {
-        for(uint32 i = 0; i < L; i++)
-            buf[i] = s.c_str()[i];
+        copy_from(s.c_str(), s.length());
         return *this;
     }
 
     template <uint32 nn> StaticString& operator = (StaticString<nn>& s)
     {
-        for(uint32 i = 0; i < min(L,nn); i++)
-            buf[i] = s.c_str()[i];
+        copy_from(s.c_str(), s.length());
         return *this;
     }
 
@@ -137,14 +136,7 @@ public:
      */
     StaticString& operator=(const char* c)
     {
-        uint32 i = 0;
-        for(; i < L-1; i++)
-        {
-            buf[i] = c[i];
-            if(buf[i] == '\0')
-                return *this;
-        }
-        buf[i] = '\0';
+        copy_from(c, L);
         return *this;
     }
 
@@ -153,14 +145,7 @@ public:
      */
     StaticString& operator=(char* c)
     {
-        uint32 i = 0;
-        for(; i < L-1; i++)
-        {
-            buf[i] = c[i];
-            if(buf[i] == '\0')
-                return *this;
-        }
-        buf[i] = '\0';
+        copy_from(c, L);
         return *this;
     }
 
@@ -172,9 +157,10 @@ public:
 
     template<typename T> StaticString& operator=(T i)
     {
-        buf[0] = '\0';
-        Rope r(buf, L);
+        set_length(0);
+        Rope r = tail();
         r << i;
+        set_length(r.get_cursor());
         return *this;
     }
 
@@ -183,10 +169,7 @@ public:
      */
     StaticString& operator + (Rope& s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r = r + s;
-        return *this;
+        return (*this += s);
     }
 
     /**
@@ -194,9 +177,7 @@ public:
      */
     template <uint32 N> StaticString& operator += (StaticString<N> & s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r += s.c_str();
+        append_from(s.c_str(), s.length());
         return *this;
     }
 
@@ -205,21 +186,21 @@ public:
      */
     template <uint32 N> StaticString& operator += (Vector<N> v)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
+        Rope r = tail();
         for(uint32 i = 0; i < N-1; i++)
         {
             r << v[i] << ", ";
         }
         r << v[N-1];
+        set_length(r.get_cursor());
         return *this;
     }
 
     StaticString& operator += (Rope& s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
+        Rope r = tail();
         r += s;
+        set_length(r.get_cursor());
         return *this;
     }
 
@@ -228,10 +209,9 @@ public:
      */
     void append(float f, uint8 precision=default_float_precision)
     {
-        char temp[20];
-        Rope r(temp, 20);
+        Rope r = tail();
         r.append(f, precision);
-        *this += temp;
+        set_length(r.get_cursor());
     }
 
     /**
@@ -239,20 +219,16 @@ public:
      */
     void append(double f, uint8 precision=default_float_precision)
     {
-        char temp[20];
-        Rope r(temp, 20);
+        Rope r = tail();
         r.append(f, precision);
-        *this += temp;
+        set_length(r.get_cursor());
     }
     /**
      * \brief Appends a float to this.
      */
     StaticString& operator += (float f)
     {
-        char temp[20];
-        Rope r(temp, 20);
-        r.append(f, default_float_precision);
-        *this += r.c_str();
+        append(f, default_float_precision);
         return *this;
     }
 
@@ -261,10 +237,7 @@ public:
      */
     StaticString& operator += (double f)
     {
-        char temp[20];
-        Rope r(temp, 20);
-        r.append(f, default_float_precision);
-        *this += r.c_str();
+        append(f, default_float_precision);
         return *this;
     }
 
@@ -273,10 +246,9 @@ public:
      */
     StaticString& operator += (int32 f)
     {
-        char temp[20];
-        Rope r(temp, 20);
+        Rope r = tail();
         r << f;
-        *this += r.c_str();
+        set_length(r.get_cursor());
         return *this;
     }
 
@@ -285,58 +257,54 @@ public:
      */
     StaticString& operator += (uint32 f)
     {
-        char temp[20];
-        Rope r(temp, 20);
+        Rope r = tail();
         r << f;
-        *this += r.c_str();
+        set_length(r.get_cursor());
         return *this;
     }
 
     StaticString& operator + (char* s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r += s;
+        append_from(s, L);
         return *this;
     }
 
     StaticString& operator += (char c)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r << c;
+        uint32 n = min(length(), L-1);
+        if((c != '\0') && (n < L-1))
+            buf[n++] = c;
+        set_length(n);
         return *this;
     }
 
     StaticString& operator += (char* s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r += s;
+        append_from(s, L);
         return *this;
     }
 
     StaticString& operator + (const char* s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r += s;
+        append_from(s, L);
         return *this;
     }
 
     StaticString& operator += (const char* s)
     {
-        Rope r(buf, L);
-        r.set_cursor(r.length());
-        r += s;
+        append_from(s, L);
         return *this;
     }
 
     /**
      * \brief This operator overload allows you to access and modify individual characters in the string.
+     *
+     * Writing through the reference could move the terminator, so the
+     * string counts its length again the next time it's asked for.
      */
     char& operator [](uint32 p)
     {
+        cached_length = UNKNOWN_LENGTH;
         if(p >= L)
             return buf[L-1];
         return buf[p];
@@ -392,7 +360,7 @@ public:
     template <uint32 N> bool compare(StaticString<N>& s, uint32 max_len)
     {
         Rope rope(buf, L);
-        return rope.compare(s.buf, min(max_len, L));
+        return rope.compare(s.c_str(), min(max_len, L));
     }
 
     /**
@@ -406,8 +374,11 @@ public:
 
     template <uint32 N> bool compare(StaticString<N>& s)
     {
+        uint32 n = length();
+        if(n != s.length())
+            return false;
         Rope rope(buf, L);
-        return rope.compare(s.buf, L);
+        return rope.compare(s.c_str(), 0, 0, n);
     }
 
     bool compare(const char* s)
@@ -450,6 +421,24 @@ public:
         return rope.atoi(p);
     }
 
+    /**
+     * \brief Parses a number starting at position p. The result says where
+     * the number ended and if anything went wrong.
+     * @code
+     etk::StaticString<20> ss("$T,-12.5");
+     float f;
+     etk::ParseResult r = ss.parse(f, 3);
+     //f == -12.5f, r.error == etk::ParseResult::OK
+     @endcode
+     */
+    template <typename T> ParseResult parse(T& value, uint32 p=0) const
+    {
+        uint32 n = min(length(), L-1);
+        if(p > n)
+            p = n;
+        return parse_number(&buf[p], &buf[n], value);
+    }
+
     uint32 parse_hex(uint16 p=0)
     {
         Rope rope(buf, L);
@@ -458,16 +447,17 @@ public:
 
     /**
      * \brief Returns the number of characters in the string.
+     *
+     * The length is kept up to date by everything that changes the string, so
+     * this doesn't have to look for the terminator. The exception is after
+     * the buffer has been written to directly, through operator[],
+     * raw_memory() or get_rope(), when it's counted once more.
      */
     uint32 length() const
     {
-        uint32 i = 0;
-        for(; i < L; i++)
-        {
-            if(buf[i] == '\0')
-                break;
-        }
-        return i;
+        if(cached_length == UNKNOWN_LENGTH)
+            cached_length = Rope::c_strlen(buf, L);
+        return cached_length;
     }
 
     /**
@@ -477,6 +467,7 @@ public:
     {
         Rope rope(buf, L);
         rope.clear();
+        cached_length = 0;
     }
 
     bool operator == (Rope r)
@@ -496,22 +487,29 @@ public:
         return (r1 != r);
     }
 
+    /**
+     * \brief Returns a Rope that writes over the string from the start.
+     */
     Rope get_rope()
     {
+        cached_length = UNKNOWN_LENGTH;
         Rope rope(buf, L);
         return rope;
     }
 
     /**
-     * \brief Inserts a character in a position.
+     * \brief Inserts a character in a position. If the string is full, the
+     * last character is lost.
      */
     void insert(char c, uint32 pos)
     {
-        if(pos < L-1)
+        uint32 n = min(length(), L-2);
+        if((pos < L-1) && (pos <= n))
         {
-            for(uint32 i = length()+1; i != pos; i--)
+            for(uint32 i = n; i != pos; i--)
                 buf[i] = buf[i-1];
             buf[pos] = c;
+            set_length(n+1);
         }
     }
 
@@ -520,10 +518,12 @@ public:
      */
     void remove(uint32 pos)
     {
-        if(pos < L)
+        uint32 n = min(length(), L-1);
+        if(pos < n)
         {
-            for(uint32 i = pos; i < L-1; i++)
+            for(uint32 i = pos; i < n; i++)
                 buf[i] = buf[i+1];
+            set_length(n-1);
         }
     }
 
@@ -532,10 +532,13 @@ public:
      */
     void erase(uint32 pos, uint32 len)
     {
-        if((pos+len) < L)
+        uint32 n = min(length(), L-1);
+        if(((pos+len) < L) && (pos < n))
         {
-            for(uint32 i = pos; i < L-1; i++)
-                buf[i] = buf[min(L-1, i+len)];
+            len = min(len, n-pos);
+            for(uint32 i = pos; i+len < n; i++)
+                buf[i] = buf[i+len];
+            set_length(n-len);
         }
     }
 
@@ -545,6 +548,7 @@ public:
         {
             for(uint32 i = pos; i < (pos+len); i++)
                 buf[i] = c;
+            cached_length = UNKNOWN_LENGTH;
         }
     }
 
@@ -595,6 +599,7 @@ public:
      */
     char* raw_memory()
     {
+        cached_length = UNKNOWN_LENGTH;
         return buf;
     }
 
@@ -658,70 +663,103 @@ public:
 #ifndef __AVR__
     template<typename... Args> void scan(Args&... args)
     {
-        _scan(buf, args...);
+        _scan(0, args...);
     }
 #endif
 
 private:
+    static const uint32 UNKNOWN_LENGTH = 0xFFFFFFFF;
+
+    /**
+     * \brief Returns a Rope with its cursor at the end of the string, for
+     * formatting numbers straight in to the buffer.
+     */
+    Rope tail()
+    {
+        Rope r(buf, L);
+        r.set_cursor(min(length(), L-1));
+        return r;
+    }
+
+    void set_length(uint32 n)
+    {
+        buf[n] = '\0';
+        cached_length = n;
+    }
+
+    // copies up to n characters of s, stopping at the terminator or when full
+    void copy_from(const char* s, uint32 n)
+    {
+        uint32 i = 0;
+        for(; (i < n) && (i < L-1) && (s[i] != '\0'); i++)
+            buf[i] = s[i];
+        set_length(i);
+    }
+
+    void append_from(const char* s, uint32 n)
+    {
+        uint32 at = min(length(), L-1);
+        for(uint32 i = 0; (i < n) && (at < L-1) && (s[i] != '\0'); i++)
+            buf[at++] = s[i];
+        set_length(at);
+    }
 
 #ifndef __AVR__
-    template<typename T> void _scan(const char* bbuf, T& t)
+    // finds the next number at or after count and returns the position after it
+    template<typename T> uint32 scan_one(uint32 count, T& t)
     {
-        uint32 count = 0;
-        while(count < L)
+        uint32 n = min(length(), L-1);
+        while(count < n)
         {
-            char c = bbuf[count++];
-            if(c == '\0')
-                break;
-            else if(is_numeric(c) || (c == '-'))
+            char c = buf[count];
+            if(is_numeric(c) || (c == '-'))
             {
-                char cbuf[20];
-                Rope rope(cbuf, 20, &bbuf[count-1]);
+                ParseResult r;
                 if(std::is_integral<T>::value)
-                    t = rope.atoi();
-                if(std::is_floating_point<T>::value)
-                    t = rope.atof();
-                while(is_numeric(c) || (c == '-') || (c == '.'))
                 {
-                    c = bbuf[count++];
-                    if(count > L)
-                        break;
+                    int64 v = 0;
+                    r = parse_number(&buf[count], &buf[n], v);
+                    if(r.error != ParseResult::NO_NUMBER)
+                        t = static_cast<T>(v);
+                }
+                else
+                {
+                    double v = 0;
+                    r = parse_number(&buf[count], &buf[n], v);
+                    if(r.error != ParseResult::NO_NUMBER)
+                        t = static_cast<T>(v);
                 }
-                break;
-            }
-        }
-    }
 
-    template<typename T, typename... Args> void _scan(const char* bbuf, T& t, Args&... args)
-    {
-        uint32 count = 0;
-        while(count < L)
-        {
-            char c = bbuf[count++];
-            if(c == '\0')
-                break;
-            else if(is_numeric(c) || (c == '-'))
-            {
-                char cbuf[20];
-                Rope rope(cbuf, 20, &bbuf[count-1]);
-                if(std::is_integral<T>::value)
-                    t = rope.atoi();
-                if(std::is_floating_point<T>::value)
-                    t = rope.atof();
-                while(is_numeric(c) || (c == '-') || (c == '.'))
+                if(r.error == ParseResult::NO_NUMBER)
                 {
-                    c = bbuf[count++];
-                    if(count > L)
-                        break;
+                    count++;
+                    continue;
                 }
+
+                // skip whatever is left of it, like the fraction of an integer
+                count = r.end - buf;
+                while((count < n) && (is_numeric(buf[count]) || (buf[count] == '.')))
+                    count++;
                 break;
             }
+            count++;
         }
-        _scan(&bbuf[count], args...);
+        return count;
+    }
+
+    template<typename T> void _scan(uint32 count, T& t)
+    {
+        scan_one(count, t);
+    }
+
+    template<typename T, typename... Args> void _scan(uint32 count, T& t, Args&... args)
+    {
+        _scan(scan_one(count, t), args...);
     }
 #endif
 
     char buf[L];
+    mutable uint32 cached_length;
 };
 
 
@@ -16,11 +16,233 @@
 #ifndef ETK_SHORT_TERM_MEMORY_H
 #define ETK_SHORT_TERM_MEMORY_H
 
+#include "types.h"
 #include "loop_range.h"
 
 namespace etk
 {
 
+/**
+ * \brief Keeps the sum of a sliding window of values.
+ *
+ * The generic version simply adds and subtracts. Integers are summed exactly in 64 bits and
+ * floating point values use Kahan summation, so the sum doesn't drift as values come and go.
+ */
+template <typename T> struct WindowSum
+{
+    void set(T t, uint32 n)
+    {
+        sum = T();
+        for(uint32 i = 0; i < n; i++)
+            sum = sum + t;
+    }
+
+    void replace(T out, T in)
+    {
+        sum = sum - out + in;
+    }
+
+    T mean(uint32 n) const
+    {
+        return sum/n;
+    }
+
+    T sum;
+};
+
+template <typename T, typename ACC> struct ExactWindowSum
+{
+    void set(T t, uint32 n)
+    {
+        sum = (ACC)t * n;
+    }
+
+    void replace(T out, T in)
+    {
+        sum += (ACC)in - (ACC)out;
+    }
+
+    T mean(uint32 n) const
+    {
+        return (T)(sum/(ACC)n);
+    }
+
+    ACC sum;
+};
+
+template <typename T> struct KahanWindowSum
+{
+    void set(T t, uint32 n)
+    {
+        sum = (real_t)t * n;
+        c = 0;
+    }
+
+    void replace(T out, T in)
+    {
+        add(-(real_t)out);
+        add((real_t)in);
+    }
+
+    T mean(uint32 n) const
+    {
+        return (T)(sum/n);
+    }
+
+    void add(real_t x)
+    {
+        real_t y = x - c;
+        real_t t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+
+    real_t sum;
+    real_t c;
+};
+
+template <> struct WindowSum<int8> : ExactWindowSum<int8, int64> { };
+template <> struct WindowSum<uint8> : ExactWindowSum<uint8, int64> { };
+template <> struct WindowSum<int16> : ExactWindowSum<int16, int64> { };
+template <> struct WindowSum<uint16> : ExactWindowSum<uint16, int64> { };
+template <> struct WindowSum<int32> : ExactWindowSum<int32, int64> { };
+template <> struct WindowSum<uint32> : ExactWindowSum<uint32, int64> { };
+template <> struct WindowSum<float> : KahanWindowSum<float> { };
+template <> struct WindowSum<double> : KahanWindowSum<double> { };
+
+
+/**
+ * \brief Tracks the smallest (or largest if MAX is true) of the last LEN values.
+ *
+ * This is a monotonic queue. Values that can never be the extreme again because a newer value
+ * beats them are dropped as soon as they arrive, so the front of the queue is always the answer.
+ * Each value is added and removed at most once, so put() is O(1) amortised.
+ */
+template <typename T, uint32 LEN, typename IDX, bool MAX> class WindowExtreme
+{
+public:
+    void set(T t, uint32 seq)
+    {
+        front = 0;
+        n = 1;
+        q[0].value = t;
+        q[0].seq = seq;
+    }
+
+    void put(T t, uint32 seq)
+    {
+        // forget values that have left the window
+        while((n > 0) && ((uint32)(seq - q[front].seq) >= LEN))
+        {
+            front = (front + 1) % LEN;
+            n--;
+        }
+
+        // and values that this one beats
+        while(n > 0)
+        {
+            T& back = q[(front + n - 1) % LEN].value;
+            if(MAX ? (back > t) : (back < t))
+                break;
+            n--;
+        }
+
+        Entry& e = q[(front + n) % LEN];
+        e.value = t;
+        e.seq = seq;
+        n++;
+    }
+
+    T get() const
+    {
+        return q[front].value;
+    }
+
+private:
+    struct Entry
+    {
+        T value;
+        uint32 seq;
+    };
+
+    Entry q[LEN];
+    IDX front;
+    IDX n;
+};
+
+
+/**
+ * \brief The statistics that ShortTermMemory keeps up to date when INCREMENTAL is true.
+ */
+template <typename T, uint32 LEN, typename IDX, bool INCREMENTAL> class WindowStatistics
+{
+public:
+    void set(T t)
+    {
+        seq = LEN - 1;
+        sum.set(t, LEN);
+        lowest.set(t, seq);
+        highest.set(t, seq);
+        mean = t;
+        m2 = 0;
+    }
+
+    void put(T out, T in)
+    {
+        seq++;
+        sum.replace(out, in);
+        lowest.put(in, seq);
+        highest.put(in, seq);
+
+        // Welford's update for a window of fixed length, where one value
+        // leaves as another arrives
+        real_t old_mean = mean;
+        real_t x = (real_t)in - (real_t)out;
+        mean += x/LEN;
+        m2 += x*(((real_t)in - mean) + ((real_t)out - old_mean));
+        if(m2 < 0)
+            m2 = 0;
+    }
+
+    T average(const T* buf) const
+    {
+        (void)(buf);
+        return sum.mean(LEN);
+    }
+
+    uint32 seq;
+    WindowSum<T> sum;
+    WindowExtreme<T, LEN, IDX, false> lowest;
+    WindowExtreme<T, LEN, IDX, true> highest;
+    real_t mean;
+    real_t m2;
+};
+
+template <typename T, uint32 LEN, typename IDX> class WindowStatistics<T, LEN, IDX, false>
+{
+public:
+    void set(T t)
+    {
+        (void)(t);
+    }
+
+    void put(T out, T in)
+    {
+        (void)(out);
+        (void)(in);
+    }
+
+    T average(const T* buf) const
+    {
+        T avg = T();
+        for(auto i : range(LEN))
+            avg = avg + buf[i];
+        avg = avg/LEN;
+        return avg;
+    }
+};
+
+
 /**
  * \class ShortTermMemory
  *
@@ -30,6 +252,11 @@ namespace etk
  *
  * ShortTermMemory is also iterable, which make it nice and easy to use.
  *
+ * average() adds up every item each time it's called. If INCREMENTAL is true the sum, the minimum,
+ * the maximum and the variance are instead kept up to date as items are put, so reading them is O(1).
+ * This costs the memory for two queues of LEN items for minimum() and maximum(). In incremental mode the
+ * memory starts off filled with T() so that the statistics always describe all LEN items.
+ *
  * Example
  * @code
  etk::ShortTermMemory<float, 10> stm;
@@ -41,17 +268,23 @@ namespace etk
     @endcode
  * Output: 5 5.1 5.2 5.3 5.4 5.5 5.6 5.7 5.8 5.9
  *
- * @tparam L the maximum length of the string in bytes.
+ * @tparam T the type of data to remember.
+ * @tparam LEN the number of items to remember.
+ * @tparam IDX The type used for positions. The default suits small MCUs; use uint32 to remember
+ * more than 65535 items.
+ * @tparam INCREMENTAL Keep running statistics as items are put.
  */
 
 
-template <typename T, uint32 LEN> class ShortTermMemory
+template <typename T, uint32 LEN, typename IDX = uint16, bool INCREMENTAL = false> class ShortTermMemory
 {
+    static_assert(LEN <= (uint32)(IDX)(~(IDX)0), "LEN is too big for the index type. Use a wider IDX.");
+
 public:
     class Iterator
     {
     public:
-        inline Iterator(ShortTermMemory<T,LEN>& p, uint32 position=0) : stm(p)
+        inline Iterator(ShortTermMemory<T,LEN,IDX,INCREMENTAL>& p, uint32 position=0) : stm(p)
         {
             pos = position;
         }
@@ -78,7 +311,7 @@ public:
         }
 
     private:
-        ShortTermMemory<T,LEN>& stm;
+        ShortTermMemory<T,LEN,IDX,INCREMENTAL>& stm;
         uint32 pos = 0;
     };
 
@@ -87,6 +320,12 @@ public:
     {
         start = 0;
         buf_end = 0;
+        if(INCREMENTAL)
+        {
+            for(auto i : range(LEN))
+                buf[i] = T();
+            stats.set(T());
+        }
     }
 
     Iterator begin()
@@ -105,6 +344,7 @@ public:
     void put(T b)
     {
         buf_end = (buf_end + 1) % LEN;
+        stats.put(buf[buf_end], b);
         buf[buf_end] = b;
         if(is_full())
         {
@@ -126,14 +366,16 @@ public:
     void increment()
     {
         buf_end = (buf_end + 1) % LEN;
+        // the item there stays, but it's now the newest as far as the statistics go
+        stats.put(buf[buf_end], buf[buf_end]);
     }
 
     /**
      * \brief Returns the next item without removing it from memory.
      */
-    T peek_ahead(uint16 n=0)
+    T peek_ahead(IDX n=0)
     {
-        uint16 pos = (start+n) % LEN;
+        IDX pos = (start+n) % LEN;
         return buf[pos];
     }
 
@@ -144,6 +386,12 @@ public:
     {
         start = 0;
         buf_end = 0;
+        if(INCREMENTAL)
+        {
+            for(auto i : range(LEN))
+                buf[i] = T();
+            stats.set(T());
+        }
     }
 
     /**
@@ -158,21 +406,49 @@ public:
         }
         start = 0;
         buf_end = LEN-1;
+        stats.set(t);
     }
 
+    /**
+     * \brief Returns the average of everything in memory.
+     */
     T average()
     {
-        T avg;
-        for(auto i : range(LEN))
-            avg = avg + buf[i];
-        avg = avg/LEN;
-        return avg;
+        return stats.average(buf);
+    }
+
+    /**
+     * \brief Returns the smallest item in memory. Needs INCREMENTAL.
+     */
+    T minimum()
+    {
+        static_assert(INCREMENTAL, "minimum() needs an INCREMENTAL ShortTermMemory.");
+        return stats.lowest.get();
+    }
+
+    /**
+     * \brief Returns the largest item in memory. Needs INCREMENTAL.
+     */
+    T maximum()
+    {
+        static_assert(INCREMENTAL, "maximum() needs an INCREMENTAL ShortTermMemory.");
+        return stats.highest.get();
+    }
+
+    /**
+     * \brief Returns the population variance of everything in memory. Needs INCREMENTAL.
+     */
+    real_t variance()
+    {
+        static_assert(INCREMENTAL, "variance() needs an INCREMENTAL ShortTermMemory.");
+        return stats.m2/LEN;
     }
 
 private:
-    uint16 start;
-    uint16 buf_end;
+    IDX start;
+    IDX buf_end;
     T buf[LEN];
+    WindowStatistics<T, LEN, IDX, INCREMENTAL> stats;
 };
 
 };
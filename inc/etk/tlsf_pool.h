@@ -0,0 +1,448 @@
+/*
+   Copyright (C) 2022 Samuel Cowen samuel.cowen@camelsoftware.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+   */
+
+#ifndef ETK_TLSF_POOL_H_INCLUDED
+#define ETK_TLSF_POOL_H_INCLUDED
+
+#include <string.h>
+#include "types.h"
+#include "pool.h"
+
+
+namespace etk
+{
+    constexpr uint32 tlsf_log2(uint32 n)
+    {
+        return (n < 2) ? 0 : 1 + tlsf_log2(n/2);
+    }
+
+
+    /**
+     * TlsfPool is a memory pool with bounded, constant time alloc and free.
+     *
+     * MemPool keeps a single first-fit free list. When the pool is fragmented
+     * that list gets long, and when it fails the whole pool is coalesced.
+     * TlsfPool instead sorts free blocks into segregated lists by size class
+     * (two level segregated fit). A pair of bitmaps records which lists are
+     * non-empty, so finding a suitable block is a couple of bit scans.
+     * Every block knows the size of its physical predecessor, so free blocks
+     * are merged with both neighbours as soon as they are freed and coalesce()
+     * never has anything to do.
+     *
+     * TlsfPool implements the Pool interface, so it can be used anywhere a
+     * MemPool is used.
+     *
+     * SIZE = number of bytes to reserve for the pool
+     * CHUNK_SIZE = the allocation granularity. Every allocation uses at least
+     * one chunk, including a small block header.
+     */
+    template <uint32 SIZE, uint32 CHUNK_SIZE = 64> class TlsfPool final : public Pool
+    {
+        public:
+            TlsfPool()
+            {
+                begin();
+            }
+
+            ~TlsfPool() { }
+
+            /**
+             * Initialises the pool. See MemPool::begin()
+             */
+            void begin()
+            {
+                static_assert(SIZE%CHUNK_SIZE == 0, "The memory pool size must be a multiple of the chunk size.");
+                static_assert(CHUNK_SIZE > sizeof(BlockHead), "CHUNK_SIZE is too small.");
+                static_assert(TOTAL_CHUNKS > 0, "The memory pool must hold at least one chunk.");
+
+                fl_bitmap = 0;
+                for(uint32 i = 0; i < FL_COUNT; i++)
+                {
+                    sl_bitmap[i] = 0;
+                    for(uint32 j = 0; j < SL_COUNT; j++)
+                        free_heads[i][j] = NIL;
+                }
+
+                blocks[0].head.size = TOTAL_CHUNKS;
+                blocks[0].head.prev_phys = 0;
+                insert_free(0);
+            }
+
+            /**
+             * alloc allocates a block of memory of at least sz bytes.
+             */
+            void* alloc(uint32 sz)
+            {
+                uint32 n_chunks = chunks_for(sz);
+                if(n_chunks > TOTAL_CHUNKS) {
+                    return nullptr;
+                }
+
+                uint32 b = find_free(n_chunks);
+                if(b == NIL) {
+                    return nullptr;
+                }
+
+                remove_free(b);
+                if(blocks[b].head.size > n_chunks) {
+                    split(b, n_chunks);
+                }
+                blocks[b].head.ref = 1;
+                return payload(b);
+            }
+
+            /**
+             * realloc will resize an allocation to make it either bigger or smaller.
+             * If the block cannot be grown in place, it is moved. If there is
+             * not enough memory, nullptr is returned and the original allocation is
+             * left untouched.
+             */
+            void* realloc(void* ptr, uint32 sz)
+            {
+                if(ptr == nullptr) {
+                    return alloc(sz);
+                }
+
+                uint32 b = block_of(ptr);
+                uint32 n_chunks = chunks_for(sz);
+                uint32 old_chunks = blocks[b].head.size;
+
+                if(n_chunks > TOTAL_CHUNKS) {
+                    return nullptr;
+                }
+
+                if(n_chunks < old_chunks)
+                {
+                    split(b, n_chunks);
+                    return ptr;
+                }
+                else if(n_chunks == old_chunks)
+                {
+                    return ptr;
+                }
+
+                // try to grow into the next block
+                uint32 next = b + old_chunks;
+                if((next < TOTAL_CHUNKS) && is_free(next) &&
+                        (old_chunks + blocks[next].head.size >= n_chunks))
+                {
+                    remove_free(next);
+                    blocks[b].head.size += blocks[next].head.size;
+                    fix_next_prev_phys(b);
+                    if(blocks[b].head.size > n_chunks) {
+                        split(b, n_chunks);
+                    }
+                    return ptr;
+                }
+
+                void* n = alloc(sz);
+                if(n == nullptr) {
+                    return nullptr;
+                }
+                memcpy(n, ptr, (old_chunks*CHUNK_SIZE) - sizeof(BlockHead));
+                release(b);
+                return n;
+            }
+
+            /**
+             * free releases a block of memory back to the memory pool.
+             * The block is merged with any free neighbours straight away.
+             */
+            void free(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    release(block_of(ptr));
+                }
+            }
+
+            uint32 ref(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    uint32 b = block_of(ptr);
+                    blocks[b].head.ref++;
+                    return blocks[b].head.ref;
+                }
+                return 0;
+            }
+
+            uint32 unref(void* ptr)
+            {
+                if(ptr != nullptr)
+                {
+                    uint32 b = block_of(ptr);
+                    if(blocks[b].head.ref > 0)
+                    {
+                        blocks[b].head.ref--;
+                        if(blocks[b].head.ref == 0)
+                        {
+                            release(b);
+                            return 0;
+                        }
+                        return blocks[b].head.ref;
+                    }
+                }
+                return 0;
+            }
+
+            /**
+             * Free blocks are merged as soon as they are released, so there is
+             * never anything to coalesce. Always returns zero.
+             */
+            uint32 coalesce()
+            {
+                return 0;
+            }
+
+            void* get_memory() {
+                return &blocks[0];
+            }
+
+        private:
+            static const uint32 TOTAL_CHUNKS = SIZE/CHUNK_SIZE;
+            static const uint32 NIL = 0xFFFFFFFF;
+
+            // each first level list is split into 2^SL_LOG2 second level lists
+            static const uint32 SL_LOG2 = 3;
+            static const uint32 SL_COUNT = 1 << SL_LOG2;
+
+            static const uint32 FL_COUNT = (TOTAL_CHUNKS < SL_COUNT) ? 1 :
+                (tlsf_log2(TOTAL_CHUNKS) - SL_LOG2 + 2);
+
+            static_assert(FL_COUNT <= 32, "Too many first level size classes.");
+
+            // how many blocks of the request's own size class are looked at
+            // when every bigger class is empty
+            static const uint32 MAX_PROBES = 4;
+
+            // chunk numbers are used instead of pointers so the header is the
+            // same size on every platform
+            struct alignas(8) BlockHead {
+                uint32 size;        // size of this block in chunks
+                uint32 prev_phys;   // size of the block physically before this one
+                uint32 ref;         // reference count, zero when free
+                uint32 next_free;
+                uint32 prev_free;
+            };
+
+            typedef union Block
+            {
+                BlockHead head;
+                uint8 bytes[CHUNK_SIZE];
+                void* alignment;
+            }Block;
+
+            static_assert(sizeof(Block) == CHUNK_SIZE, "Block does not equal chunk size");
+
+            static uint32 msb(uint32 n)
+            {
+                return 31 - __builtin_clz(n);
+            }
+
+            static uint32 lsb(uint32 n)
+            {
+                return __builtin_ctz(n);
+            }
+
+            static uint32 chunks_for(uint32 sz)
+            {
+                uint32 N = sz+sizeof(BlockHead);
+                return N / CHUNK_SIZE + ((N % CHUNK_SIZE != 0) * 1);
+            }
+
+            /**
+             * Maps a block size to the first and second level list it belongs in.
+             */
+            static void mapping(uint32 n, uint32& fl, uint32& sl)
+            {
+                if(n < SL_COUNT)
+                {
+                    fl = 0;
+                    sl = n;
+                }
+                else
+                {
+                    uint32 m = msb(n);
+                    fl = m - SL_LOG2 + 1;
+                    sl = (n >> (m - SL_LOG2)) - SL_COUNT;
+                }
+            }
+
+            /**
+             * Finds a free block of at least n chunks.
+             * The request is rounded up to the next size class so that any block
+             * in the chosen list is big enough.
+             */
+            uint32 find_free(uint32 n)
+            {
+                uint32 fl, sl;
+                uint32 rounded = n;
+                if(n >= SL_COUNT) {
+                    rounded += (1u << (msb(n) - SL_LOG2)) - 1;
+                }
+                mapping(rounded, fl, sl);
+
+                if(fl < FL_COUNT)
+                {
+                    uint32 sl_map = sl_bitmap[fl] & (0xFFFFFFFF << sl);
+                    if(sl_map == 0)
+                    {
+                        uint32 fl_map = (fl+1 < 32) ? (fl_bitmap & (0xFFFFFFFF << (fl+1))) : 0;
+                        if(fl_map != 0)
+                        {
+                            fl = lsb(fl_map);
+                            sl_map = sl_bitmap[fl];
+                        }
+                    }
+                    if(sl_map != 0) {
+                        return free_heads[fl][lsb(sl_map)];
+                    }
+                }
+
+                // nothing in the rounded up classes, but a block in the request's
+                // own class may still be big enough. this only happens when the
+                // pool is nearly full. only the first few are checked so that
+                // the search stays bounded.
+                mapping(n, fl, sl);
+                uint32 b = free_heads[fl][sl];
+                for(uint32 probes = 0; (b != NIL) && (probes < MAX_PROBES); probes++)
+                {
+                    if(blocks[b].head.size >= n) {
+                        return b;
+                    }
+                    b = blocks[b].head.next_free;
+                }
+                return NIL;
+            }
+
+            void insert_free(uint32 b)
+            {
+                uint32 fl, sl;
+                mapping(blocks[b].head.size, fl, sl);
+
+                blocks[b].head.ref = 0;
+                blocks[b].head.prev_free = NIL;
+                blocks[b].head.next_free = free_heads[fl][sl];
+                if(free_heads[fl][sl] != NIL) {
+                    blocks[free_heads[fl][sl]].head.prev_free = b;
+                }
+                free_heads[fl][sl] = b;
+
+                fl_bitmap |= (1u << fl);
+                sl_bitmap[fl] |= (1u << sl);
+            }
+
+            void remove_free(uint32 b)
+            {
+                uint32 fl, sl;
+                mapping(blocks[b].head.size, fl, sl);
+
+                uint32 next = blocks[b].head.next_free;
+                uint32 prev = blocks[b].head.prev_free;
+                if(next != NIL) {
+                    blocks[next].head.prev_free = prev;
+                }
+                if(prev != NIL) {
+                    blocks[prev].head.next_free = next;
+                }
+                else
+                {
+                    free_heads[fl][sl] = next;
+                    if(next == NIL)
+                    {
+                        sl_bitmap[fl] &= ~(1u << sl);
+                        if(sl_bitmap[fl] == 0) {
+                            fl_bitmap &= ~(1u << fl);
+                        }
+                    }
+                }
+                // mark as used until it is either allocated or reinserted
+                blocks[b].head.ref = 1;
+            }
+
+            /**
+             * Trims block b down to n chunks and releases the tail.
+             */
+            void split(uint32 b, uint32 n)
+            {
+                uint32 rest = b + n;
+                blocks[rest].head.size = blocks[b].head.size - n;
+                blocks[rest].head.prev_phys = n;
+                blocks[b].head.size = n;
+                fix_next_prev_phys(rest);
+                release(rest);
+            }
+
+            /**
+             * Marks block b as free, merges it with its neighbours and puts it on
+             * the appropriate free list.
+             */
+            void release(uint32 b)
+            {
+                uint32 next = b + blocks[b].head.size;
+                if((next < TOTAL_CHUNKS) && is_free(next))
+                {
+                    remove_free(next);
+                    blocks[b].head.size += blocks[next].head.size;
+                }
+
+                if(b > 0)
+                {
+                    uint32 prev = b - blocks[b].head.prev_phys;
+                    if(is_free(prev))
+                    {
+                        remove_free(prev);
+                        blocks[prev].head.size += blocks[b].head.size;
+                        b = prev;
+                    }
+                }
+
+                fix_next_prev_phys(b);
+                insert_free(b);
+            }
+
+            void fix_next_prev_phys(uint32 b)
+            {
+                uint32 next = b + blocks[b].head.size;
+                if(next < TOTAL_CHUNKS) {
+                    blocks[next].head.prev_phys = blocks[b].head.size;
+                }
+            }
+
+            bool is_free(uint32 b)
+            {
+                return blocks[b].head.ref == 0;
+            }
+
+            void* payload(uint32 b)
+            {
+                return (void*)&blocks[b].bytes[sizeof(BlockHead)];
+            }
+
+            uint32 block_of(void* ptr)
+            {
+                uint8* bptr = (uint8*)ptr;
+                bptr -= sizeof(BlockHead);
+                return ((Block*)bptr) - blocks;
+            }
+
+            uint32 fl_bitmap;
+            uint32 sl_bitmap[FL_COUNT];
+            uint32 free_heads[FL_COUNT][SL_COUNT];
+            Block blocks[TOTAL_CHUNKS];
+    };
+}
+
+#endif
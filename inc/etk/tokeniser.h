@@ -16,9 +16,57 @@
 #ifndef TOKENISER_H_INCLUDED
 #define TOKENISER_H_INCLUDED
 
+#include "types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace etk
 {
 
+/**
+ * \brief Returns the first token or null character in [p, end), or end if
+ * there isn't one.
+ *
+ * On x86 this looks at 32 bytes at a time with AVX2 or 16 with SSE2. It
+ * never reads outside [p, end).
+ */
+inline const char* find_delimiter(const char* p, const char* end, char token)
+{
+#if defined(__AVX2__)
+    const __m256i tokens = _mm256_set1_epi8(token);
+    const __m256i zeros = _mm256_setzero_si256();
+    while(end - p >= 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(v, tokens), _mm256_cmpeq_epi8(v, zeros));
+        uint32 mask = static_cast<uint32>(_mm256_movemask_epi8(hits));
+        if(mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i tokens16 = _mm_set1_epi8(token);
+    const __m128i zeros16 = _mm_setzero_si128();
+    while(end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(v, tokens16), _mm_cmpeq_epi8(v, zeros16));
+        uint32 mask = static_cast<uint32>(_mm_movemask_epi8(hits));
+        if(mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while((p < end) && (*p != token) && (*p != '\0'))
+        p++;
+    return p;
+}
+
 /**
  \class Tokeniser
 
@@ -101,11 +149,121 @@ private:
 
 
 
+
+/**
+ \class BufferTokeniser
+
+ \brief A tokeniser for text that sits in one block of memory.
+
+ It finds the end of each token with find_delimiter rather than looking at one
+ character at a time. The text ends at len characters or a null character,
+ whichever comes first.
+
+ next_slice() doesn't copy anything. It points at each token where it is in
+ the buffer, so the buffer has to stay put while the tokens are in use.
+
+@code
+    const char* line = "$POW0,12,135*F5";
+    auto tok = etk::make_tokeniser(line, strlen(line), ',');
+    const char* token;
+    uint32 len;
+    while(tok.next_slice(token, len))
+        cout.write(token, len) << " ";
+@endcode
+*/
+
+class BufferTokeniser
+{
+public:
+    BufferTokeniser(const char* buf, uint32 len, const char tok)
+    {
+        pos = buf;
+        end = buf+len;
+        token = tok;
+    }
+
+    /**
+     * \brief Copies the next token to out, like Tokeniser::next.
+     */
+    template <typename Tt> bool next(Tt& out, const uint32 len)
+    {
+        if((pos == end) || (*pos == '\0'))
+            return false;
+
+        const char* found = find_delimiter(pos, end, token);
+        uint32 n = found - pos;
+        if(n >= len)
+        {
+            // doesn't fit, so copy what does and stop there
+            for(uint32 i = 0; i < len; i++)
+                out[i] = pos[i];
+            pos += len;
+            return false;
+        }
+
+        for(uint32 i = 0; i < n; i++)
+            out[i] = pos[i];
+        out[n] = '\0';
+        skip(found);
+        return true;
+    }
+
+    /**
+     * \brief Points token at the next token in the buffer and sets len to its
+     * length. The token isn't null terminated.
+     */
+    bool next_slice(const char*& tok, uint32& len)
+    {
+        if((pos == end) || (*pos == '\0'))
+            return false;
+
+        const char* found = find_delimiter(pos, end, token);
+        tok = pos;
+        len = found - pos;
+        skip(found);
+        return true;
+    }
+
+private:
+    void skip(const char* found)
+    {
+        pos = found;
+        if((pos != end) && (*pos == token))
+            pos++;
+    }
+
+    const char* pos;
+    const char* end;
+    char token;
+};
+
+
+/**
+ * \brief Character arrays are contiguous and their size is known, so they get
+ * the faster BufferTokeniser.
+ */
+template <uint32 N> class Tokeniser<char[N]> : public BufferTokeniser
+{
+public:
+    Tokeniser(const char (&_str)[N], const char tok) : BufferTokeniser(_str, N, tok)
+    {
+    }
+};
+
+
 template <typename T> Tokeniser<T> make_tokeniser(const T& l, const char t)
 {
     return Tokeniser<T>(l, t);
 }
 
+/**
+ * \brief Makes a BufferTokeniser over len characters at buf.
+ */
+inline BufferTokeniser make_tokeniser(const char* buf, uint32 len, const char t)
+{
+    return BufferTokeniser(buf, len, t);
+}
+
 }
 
 #endif
@@ -0,0 +1,87 @@
+#include "arena_test.h"
+
+#include <etk/etk.h>
+
+using namespace etk;
+
+
+bool arena_test(std::string& subtest)
+{
+    MonotonicArena<1024> arena;
+
+    subtest = "alloc bumps the top of the arena";
+    uint8* a = (uint8*)arena.alloc(10);
+    uint8* b = (uint8*)arena.alloc(3);
+    if((a == nullptr) || (b == nullptr))
+        return false;
+    // 8 byte header plus 10 bytes rounded up to 16
+    if(b != a + 24)
+        return false;
+    if(((uintptr_t)a % 8 != 0) || ((uintptr_t)b % 8 != 0))
+        return false;
+    if(arena.used() != 40)
+        return false;
+
+    subtest = "free does nothing";
+    arena.free(a);
+    if(arena.used() != 40)
+        return false;
+
+    subtest = "realloc grows the last allocation in place";
+    memcpy(b, "abc", 3);
+    if(arena.realloc(b, 100) != b)
+        return false;
+    if(arena.used() != 24 + 8 + 104)
+        return false;
+
+    subtest = "realloc copies older allocations";
+    memcpy(a, "0123456789", 10);
+    uint8* c = (uint8*)arena.realloc(a, 20);
+    if((c == a) || (c == nullptr) || (memcmp(c, "0123456789", 10) != 0))
+        return false;
+    if(arena.realloc(b, 50) != b)
+        return false;
+
+    subtest = "mark and rewind";
+    MonotonicArena<1024>::Mark m = arena.mark();
+    void* d = arena.alloc(200);
+    if(d == nullptr)
+        return false;
+    arena.rewind(m);
+    if(arena.alloc(200) != d)
+        return false;
+
+    subtest = "out of memory";
+    if(arena.alloc(1024) != nullptr)
+        return false;
+    if(arena.alloc(arena.available() - 8) == nullptr)
+        return false;
+    if(arena.available() != 0)
+        return false;
+
+    subtest = "reset";
+    arena.reset();
+    if(arena.alloc(10) != a)
+        return false;
+
+    subtest = "dynamic list on an arena";
+    arena.reset();
+    {
+        DynamicList<int> list(&arena);
+        for(int i = 0; i < 100; i++)
+        {
+            if(!list.append(i))
+                return false;
+        }
+        for(int i = 0; i < 100; i++)
+        {
+            if(list[i] != i)
+                return false;
+        }
+    }
+    // the list was only ever grown in place
+    if(arena.used() != 8 + 400)
+        return false;
+
+    return true;
+}
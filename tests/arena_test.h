@@ -0,0 +1,8 @@
+#ifndef ARENA_TEST_H
+#define ARENA_TEST_H
+
+#include <string>
+
+bool arena_test(std::string& subtest);
+
+#endif // ARENA_TEST_H
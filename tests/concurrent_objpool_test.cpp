@@ -0,0 +1,111 @@
+#include "concurrent_objpool_test.h"
+
+#include <etk/etk.h>
+#include <etk/concurrent_objpool.h>
+#include <thread>
+#include <atomic>
+
+using namespace etk;
+
+namespace
+{
+    struct Message
+    {
+        uint32 owner;
+        uint32 sequence;
+    };
+
+    typedef ConcurrentObjectArrayAllocator<Message, 64> MessagePool;
+
+    // each thread holds a few objects at a time and checks nobody else was
+    // handed the same ones
+    template <typename A> void churn(A& allocator, uint32 id, std::atomic<bool>& ok)
+    {
+        Message* held[4];
+        for(uint32 i = 0; i < 20000; i++)
+        {
+            uint32 n = 0;
+            for(; n < 4; n++)
+            {
+                held[n] = allocator.alloc();
+                if(held[n] == nullptr)
+                    break;
+                held[n]->owner = id;
+                held[n]->sequence = i;
+            }
+            for(uint32 j = 0; j < n; j++)
+            {
+                if((held[j]->owner != id) || (held[j]->sequence != i))
+                    ok = false;
+                allocator.free(held[j]);
+            }
+        }
+    }
+}
+
+
+bool concurrent_objpool_test(std::string& subtest)
+{
+    MessagePool pool;
+
+    subtest = "single threaded alloc and free";
+    Message* all[64];
+    for(uint32 i = 0; i < 64; i++)
+    {
+        all[i] = pool.alloc();
+        if(all[i] == nullptr)
+            return false;
+    }
+    if(pool.alloc() != nullptr)
+        return false;
+    for(uint32 i = 0; i < 64; i++)
+        pool.free(all[i]);
+    if(pool.available() != 64)
+        return false;
+
+    subtest = "objects from elsewhere are rejected";
+    Message m;
+    if(pool.free(&m))
+        return false;
+
+    subtest = "magazines cache and flush";
+    {
+        MessagePool::Magazine<8> mag(pool);
+        Message* a = mag.alloc();
+        if((a == nullptr) || (mag.cached() != 3))
+            return false;
+        if(pool.available() != 60)
+            return false;
+        mag.free(a);
+    }
+    if(pool.available() != 64)
+        return false;
+
+    subtest = "threads never share an object";
+    std::atomic<bool> ok(true);
+    std::thread threads[4];
+    for(uint32 t = 0; t < 4; t++)
+    {
+        threads[t] = std::thread([&pool, &ok, t]() {
+            if(t % 2)
+            {
+                MessagePool::Magazine<8> mag(pool);
+                churn(mag, t, ok);
+            }
+            else
+            {
+                churn(pool, t, ok);
+            }
+        });
+    }
+    for(uint32 t = 0; t < 4; t++)
+        threads[t].join();
+    if(!ok)
+        return false;
+
+    subtest = "every object returned";
+    if(pool.available() != 64)
+        return false;
+
+    return true;
+}
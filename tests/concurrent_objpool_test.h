@@ -0,0 +1,8 @@
+#ifndef CONCURRENT_OBJPOOL_TEST_H
+#define CONCURRENT_OBJPOOL_TEST_H
+
+#include <string>
+
+bool concurrent_objpool_test(std::string& subtest);
+
+#endif // CONCURRENT_OBJPOOL_TEST_H
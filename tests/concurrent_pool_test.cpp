@@ -0,0 +1,229 @@
+#include "concurrent_pool_test.h"
+
+#include <etk/etk.h>
+#include <thread>
+#include <atomic>
+
+using namespace etk;
+
+namespace
+{
+    typedef ConcurrentMemPool<1024*64, 64, 4> SharedPool;
+
+    struct Packet
+    {
+        uint32 owner;
+        uint32 sequence;
+    };
+
+    // a tiny single producer, single consumer hand-off so that blocks are
+    // freed by a different thread than the one that allocated them
+    struct Mailbox
+    {
+        std::atomic<Packet*> slot[16];
+    };
+}
+
+
+bool concurrent_pool_test(std::string& subtest)
+{
+    SharedPool pool;
+
+    subtest = "alloc and free on one thread";
+    void* a = pool.alloc(10);
+    void* b = pool.alloc(10);
+    if((a == nullptr) || (b == nullptr) || (a == b))
+        return false;
+    memset(a, 1, 16);
+    memset(b, 2, 16);
+    if(((uint8*)a)[15] != 1)
+        return false;
+    pool.free(a);
+    pool.free(b);
+    // freed blocks stay in the thread's cache
+    if(pool.cached() == 0)
+        return false;
+
+    subtest = "large allocations bypass the cache";
+    void* big = pool.alloc(4000);
+    if(big == nullptr)
+        return false;
+    pool.free(big);
+
+    subtest = "realloc keeps contents";
+    char* s = (char*)pool.alloc(12);
+    memcpy(s, "concurrent!", 12);
+    s = (char*)pool.realloc(s, 700);
+    if((s == nullptr) || (memcmp(s, "concurrent!", 12) != 0))
+        return false;
+    pool.free(s);
+
+    subtest = "release_thread returns everything";
+    pool.release_thread();
+#ifndef ETK_NO_POOL_STATS
+    {
+        PoolStats st = pool.stats();
+        if(st.free != st.capacity)
+            return false;
+    }
+#endif
+
+    subtest = "blocks freed by another thread";
+    std::atomic<bool> ok(true);
+    Mailbox box;
+    for(uint32 i = 0; i < 16; i++)
+        box.slot[i].store(nullptr);
+
+    std::thread producer([&]() {
+        for(uint32 i = 0; i < 20000; i++)
+        {
+            Packet* p = (Packet*)pool.alloc(sizeof(Packet));
+            if(p == nullptr) {
+                ok = false;
+                break;
+            }
+            p->owner = 1;
+            p->sequence = i;
+            while(box.slot[i % 16].load(std::memory_order_acquire) != nullptr) { }
+            box.slot[i % 16].store(p, std::memory_order_release);
+        }
+        pool.release_thread();
+    });
+    std::thread consumer([&]() {
+        for(uint32 i = 0; i < 20000; i++)
+        {
+            Packet* p;
+            while((p = box.slot[i % 16].load(std::memory_order_acquire)) == nullptr) { 
+                if(!ok)
+                    return;
+            }
+            box.slot[i % 16].store(nullptr, std::memory_order_release);
+            if((p->owner != 1) || (p->sequence != i))
+                ok = false;
+            pool.free(p);
+        }
+        pool.release_thread();
+    });
+    producer.join();
+    consumer.join();
+    if(!ok)
+        return false;
+
+    subtest = "threads that only free don't take a slot";
+    {
+        ConcurrentMemPool<1024*16, 64, 2> small;
+        void* blocks[8];
+        for(uint32 i = 0; i < 8; i++)
+            blocks[i] = small.alloc(20);
+
+        // the freer stays alive until the user is done, so its thread id
+        // can't be handed on to the user
+        std::atomic<bool> freed(false);
+        std::atomic<bool> done(false);
+        std::thread freer([&]() {
+            for(uint32 i = 0; i < 8; i++)
+                small.free(blocks[i]);
+            if(small.cached() != 0)
+                ok = false;
+            freed = true;
+            while(!done) { }
+        });
+
+        // the second slot is still free for a thread that allocates
+        while(!freed) { }
+        std::thread user([&]() {
+            small.free(small.alloc(20));
+            if(small.cached() == 0)
+                ok = false;
+            small.release_thread();
+        });
+        user.join();
+        done = true;
+        freer.join();
+        small.release_thread();
+        if(!ok)
+            return false;
+#ifndef ETK_NO_POOL_STATS
+        PoolStats st = small.stats();
+        if(st.free != st.capacity)
+            return false;
+#endif
+    }
+
+    subtest = "frees racing release_thread";
+    {
+        ConcurrentMemPool<1024*64, 64, 2> small;
+        for(uint32 round = 0; round < 200; round++)
+        {
+            std::atomic<Packet*> handoff[32];
+            for(uint32 i = 0; i < 32; i++)
+                handoff[i].store(nullptr);
+
+            std::thread owner([&]() {
+                for(uint32 i = 0; i < 32; i++)
+                    handoff[i].store((Packet*)small.alloc(sizeof(Packet)), std::memory_order_release);
+                small.release_thread();
+            });
+            std::thread freer([&]() {
+                for(uint32 i = 0; i < 32; i++)
+                {
+                    Packet* p;
+                    while((p = handoff[i].load(std::memory_order_acquire)) == nullptr) { }
+                    small.free(p);
+                }
+            });
+            owner.join();
+            freer.join();
+        }
+#ifndef ETK_NO_POOL_STATS
+        // nobody owns a slot any more, so nothing can be waiting on a queue
+        PoolStats st = small.stats();
+        if(st.free != st.capacity)
+            return false;
+#endif
+    }
+
+    subtest = "pool pointers shared between threads";
+    {
+        static std::atomic<int> alive(0);
+        struct Counted
+        {
+            Counted() { alive++; }
+            ~Counted() { alive--; }
+        };
+        auto p = pool_pointer<Counted, SharedPool>::make(pool);
+        std::thread threads[4];
+        for(uint32 t = 0; t < 4; t++)
+        {
+            threads[t] = std::thread([&pool, p]() {
+                for(uint32 i = 0; i < 1000; i++)
+                {
+                    auto q = p;
+                    auto r = q;
+                }
+                pool.release_thread();
+            });
+        }
+        for(uint32 t = 0; t < 4; t++)
+            threads[t].join();
+        if(alive != 1)
+            return false;
+        p = pool_pointer<Counted, SharedPool>::make(pool);
+        if(alive != 1)
+            return false;
+    }
+
+    subtest = "every block returned";
+    pool.release_thread();
+#ifndef ETK_NO_POOL_STATS
+    {
+        PoolStats st = pool.stats();
+        if(st.free != st.capacity)
+            return false;
+    }
+#endif
+    if(pool.coalesce() != 1)
+        return false;
+
+    return true;
+}
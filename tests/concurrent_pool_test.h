@@ -0,0 +1,8 @@
+#ifndef CONCURRENT_POOL_TEST_H
+#define CONCURRENT_POOL_TEST_H
+
+#include <string>
+
+bool concurrent_pool_test(std::string& subtest);
+
+#endif // CONCURRENT_POOL_TEST_H
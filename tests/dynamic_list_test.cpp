@@ -2,6 +2,8 @@
 
 
 #include <etk/pool.h>
+#include <etk/pool_ptr.h>
+#include "tracked.h"
 
 
 #include <iostream>
@@ -100,7 +102,7 @@ using namespace etk::experimental;
 bool dynamic_list_test(std::string& subtest)
 {
     MemPool<2048> pool;
-    DynamicList<int> list(pool);
+    experimental::DynamicList<int> list(pool);
 
     for(int i = 0; i < 20; i++)
     {
@@ -115,6 +117,121 @@ bool dynamic_list_test(std::string& subtest)
     }
     */
 
+    subtest = "linear growth does not shrink straight after a pop";
+    {
+        etk::DynamicList<int, 4> linear(&pool);
+        for(int i = 0; i < 9; i++)
+            linear.append(i);
+        if(linear.capacity() != 12)
+            return false;
+        linear.pop_back();
+        linear.pop_back();
+        if(linear.capacity() != 12)
+            return false;
+        int v = 7;
+        linear.append(v);
+        if(linear.capacity() != 12)
+            return false;
+    }
+
+    subtest = "geometric growth";
+    {
+        etk::DynamicList<int, 1, Pool, GeometricGrowth<4>> geo(&pool);
+        for(int i = 0; i < 100; i++)
+        {
+            if(!geo.append(i))
+                return false;
+        }
+        if(geo.capacity() != 128)
+            return false;
+        for(int i = 0; i < 100; i++)
+        {
+            if(geo[i] != i)
+                return false;
+        }
+        while(geo.size() > 20)
+            geo.pop_back();
+        if(geo.capacity() != 64)
+            return false;
+    }
+
+    subtest = "reserve and shrink_to_fit";
+    {
+        etk::DynamicList<int> reserved(&pool);
+        if(!reserved.reserve(50) || (reserved.capacity() != 50))
+            return false;
+        for(int i = 0; i < 50; i++)
+            reserved.append(i);
+        if(reserved.capacity() != 50)
+            return false;
+        if(reserved.reserve(100000))
+            return false;
+        reserved.pop_back();
+        reserved.pop_back();
+        reserved.shrink_to_fit();
+        if((reserved.capacity() != 48) || (reserved[47] != 47))
+            return false;
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "non-trivial items are moved when the list grows";
+    {
+        etk::DynamicList<Tracked, 2> tl(&pool);
+        for(int i = 0; i < 20; i++)
+        {
+            if(!tl.emplace_back(i))
+                return false;
+        }
+        tl.emplace(0, 100);
+        tl.insert(Tracked(101), 10);
+        tl.remove(5);
+        tl.remove_item(Tracked(12));
+        while(tl.size() > 8)
+            tl.pop_back();
+        if(Tracked::copies != 0)
+            return false;
+        if((*tl[0].v != 100) || (*tl[1].v != 0) || (*tl[5].v != 5) || (*tl[7].v != 7))
+            return false;
+
+        etk::DynamicList<Tracked, 2> moved(static_cast<etk::DynamicList<Tracked, 2>&&>(tl));
+        if((tl.size() != 0) || (moved.size() != 8) || (Tracked::copies != 0))
+            return false;
+
+        etk::DynamicList<Tracked, 2> copied(moved);
+        if((copied.size() != 8) || (Tracked::copies != 8) || (*copied[7].v != 7))
+            return false;
+        copied = static_cast<etk::DynamicList<Tracked, 2>&&>(moved);
+        if((copied.size() != 8) || (moved.size() != 0))
+            return false;
+    }
+    if((Tracked::live != 0) || (pool.coalesce() != 1))
+        return false;
+
+    subtest = "pool pointers keep their count when the list grows";
+    {
+        typedef pool_pointer<int, MemPool<2048>> IntPtr;
+        auto p = IntPtr::make(pool, 42);
+        // reads the reference count without changing it
+        auto refs = [&]() { pool.ref(&*p); return pool.unref(&*p); };
+        uint32 count = refs();
+        {
+            etk::DynamicList<IntPtr> pl(&pool);
+            for(int i = 0; i < 10; i++)
+                pl.append(p);
+            pl.emplace(0, p);
+            pl.remove(3);
+            if((pl.size() != 10) || (*pl[9] != 42))
+                return false;
+            if(refs() != count + 10)
+                return false;
+        }
+        if(refs() != count)
+            return false;
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
     return true;
 }
 
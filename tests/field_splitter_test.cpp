@@ -0,0 +1,159 @@
+#include "field_splitter_test.h"
+#include <etk/etk.h>
+#include <string.h>
+#include <iostream>
+
+using namespace etk;
+using namespace std;
+
+
+bool field_splitter_test(std::string& subtest)
+{
+    subtest = "NMEA sentence";
+    {
+        const char* line = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+        FieldSplitter splitter(",");
+        splitter.set_nmea(true);
+        Array<uint16, 24> index;
+        auto fields = splitter.split(line, strlen(line), index);
+        if(fields.size() != 15)
+            return false;
+        if(!fields.compare(0, "$GPGGA"))
+            return false;
+        if(!fields.has_checksum() || !fields.checksum_valid())
+            return false;
+        if(fields.truncated())
+            return false;
+
+        float altitude;
+        if(fields.parse(9, altitude).error != ParseResult::OK)
+            return false;
+        if(altitude != 545.4f)
+            return false;
+        uint32 satellites;
+        if((fields.parse(7, satellites).error != ParseResult::OK) || (satellites != 8))
+            return false;
+
+        uint32 len;
+        fields.get(14, len);
+        if(len != 0)
+            return false;
+        if(fields.parse(14, satellites).error != ParseResult::NO_NUMBER)
+            return false;
+        if(fields.get(15, len) != nullptr)
+            return false;
+    }
+
+    subtest = "NMEA bad checksum";
+    {
+        const char* line = "$GPGGA,123519,4807.038,N*48";
+        FieldSplitter splitter(",");
+        splitter.set_nmea(true);
+        Array<uint16, 8> index;
+        auto fields = splitter.split(line, strlen(line), index);
+        if(!fields.has_checksum() || fields.checksum_valid())
+            return false;
+        if(fields.size() != 4 || !fields.compare(3, "N"))
+            return false;
+
+        // a good checksum
+        const char* good = "$PMTK001,604,3*32";
+        fields = splitter.split(good, strlen(good), index);
+        if(!fields.checksum_valid())
+            return false;
+
+        const char* none = "$PMTK001,604,3";
+        fields = splitter.split(none, strlen(none), index);
+        if(fields.has_checksum() || fields.checksum_valid())
+            return false;
+        if(!fields.compare(2, "3"))
+            return false;
+    }
+
+    subtest = "Quoted fields";
+    {
+        const char* line = "1,\"Smith, John\",\"say \"\"hi\"\"\",,end";
+        FieldSplitter splitter(",");
+        Array<uint16, 8> index;
+        auto fields = splitter.split(line, strlen(line), index);
+        if(fields.size() != 5)
+            return false;
+        if(!fields.compare(1, "Smith, John"))
+            return false;
+        char buf[20];
+        if(!fields.copy(2, buf, 20))
+            return false;
+        if(strcmp(buf, "say \"hi\"") != 0)
+            return false;
+        if(fields.copy(2, buf, 5))
+            return false;
+        if(strcmp(buf, "say ") != 0)
+            return false;
+        if(!fields.compare(3, "") || !fields.compare(4, "end"))
+            return false;
+
+        // a quote in the middle of a field is just a character
+        const char* mid = "ab\"c,d";
+        fields = splitter.split(mid, strlen(mid), index);
+        if(fields.size() != 2 || !fields.compare(0, "ab\"c"))
+            return false;
+
+        // with quoting off the comma splits
+        splitter.set_quote('\0');
+        fields = splitter.split(line, strlen(line), index);
+        if(fields.size() != 6)
+            return false;
+    }
+
+    subtest = "Several delimiters";
+    {
+        const char* line = "key = value;other=2\tlast";
+        FieldSplitter splitter(DelimiterSet("=;\t"));
+        Array<uint16, 8> index;
+        auto fields = splitter.split(line, strlen(line), index);
+        if(fields.size() != 5)
+            return false;
+        if(!fields.compare(0, "key ") || !fields.compare(1, " value"))
+            return false;
+        if(!fields.compare(2, "other") || !fields.compare(4, "last"))
+            return false;
+        int32 two;
+        if((fields.parse(3, two).error != ParseResult::OK) || (two != 2))
+            return false;
+        if(fields.parse(1, two).error != ParseResult::NO_NUMBER)
+            return false;
+    }
+
+    subtest = "Truncation and empty records";
+    {
+        const char* line = "a,b,c,d,e";
+        FieldSplitter splitter(",");
+        Array<uint16, 4> index;
+        auto fields = splitter.split(line, strlen(line), index);
+        if(fields.size() != 3 || !fields.truncated())
+            return false;
+        if(!fields.compare(2, "c"))
+            return false;
+
+        fields = splitter.split(line, 0, index);
+        if(fields.size() != 0)
+            return false;
+
+        fields = splitter.split(",", 1, index);
+        if(fields.size() != 2 || !fields.compare(0, "") || !fields.compare(1, ""))
+            return false;
+
+        // the record stops at the first line break
+        const char* lines = "x,y\nz,w";
+        fields = splitter.split(lines, strlen(lines), index);
+        if(fields.size() != 2 || !fields.compare(1, "y"))
+            return false;
+
+        // and at len
+        fields = splitter.split(line, 3, index);
+        if(fields.size() != 2 || !fields.compare(1, "b"))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,10 @@
+#ifndef FIELD_SPLITTER_TEST_H_INCLUDED
+#define FIELD_SPLITTER_TEST_H_INCLUDED
+
+#include <string>
+
+bool field_splitter_test(std::string& subtest);
+
+
+
+#endif // FIELD_SPLITTER_TEST_H_INCLUDED
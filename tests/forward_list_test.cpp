@@ -5,8 +5,8 @@ using namespace std;
 
 bool forward_list_test(std::string& subtest)
 {
-    etk::experimental::MemPool<1024> pool;
-    etk::experimental::forward_list<int> list(&pool);
+    etk::MemPool<1024*16> pool;
+    etk::forward_list<int> list(&pool);
 
     subtest = "iterator tests";
     for(int i = 0; i < 10; i++)
@@ -46,5 +46,119 @@ bool forward_list_test(std::string& subtest)
         return false;
     }
 
+    subtest = "get by index";
+    list.free();
+    for(int i = 0; i < 100; i++)
+        list.append(i);
+    for(uint32 i = 0; i < 100; i++)
+    {
+        int* p = list.get(i);
+        if((p == nullptr) || (*p != (int)i))
+            return false;
+    }
+    if(list.get(100) != nullptr)
+        return false;
+    // going backwards starts from the head again
+    if(*list.get(3) != 3)
+        return false;
+
+    subtest = "get after the list changes";
+    list.push_head(-1);
+    if(*list.get(3) != 2)
+        return false;
+    list.pop_head();
+    list.pop_head();
+    if(*list.get(3) != 4)
+        return false;
+    list.remove_n(2);
+    if((*list.get(2) != 4) || (*list.get(50) != 52))
+        return false;
+    list.insert_after(list.begin(), 1000);
+    if((*list.get(1) != 1000) || (*list.get(2) != 2))
+        return false;
+
+    subtest = "skip index";
+    list.enable_skip_index(8);
+    for(uint32 i = 0; i < 500; i++)
+    {
+        uint32 n = (i * 37) % 98;
+        int expect = (n == 0) ? 1 : (n == 1) ? 1000 : (n == 2) ? 2 : (int)n + 1;
+        if(*list.get(n) != expect)
+            return false;
+    }
+    list.remove_item(1000);
+    if((*list.get(1) != 2) || (*list.get(97) != 99) || (list.get(98) != nullptr))
+        return false;
+    list.disable_skip_index();
+    list.free();
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "copying a skip index";
+    {
+        struct Node
+        {
+            Node* next;
+        };
+        Node nodes[40];
+        for(uint32 i = 0; i < 40; i++)
+            nodes[i].next = (i < 39) ? &nodes[i+1] : nullptr;
+
+        typedef etk::NodeIndex<Node, etk::MemPool<1024*16>> Index;
+        Index a(&pool);
+        a.enable_skip_index(4);
+        if(a.find(nodes, 30) != &nodes[30])
+            return false;
+        {
+            // each copy builds its own skip index
+            Index b(a);
+            Index c(&pool);
+            c = a;
+            if((b.find(nodes, 25) != &nodes[25]) || (c.find(nodes, 35) != &nodes[35]))
+                return false;
+            c = b;
+            if(c.find(nodes, 5) != &nodes[5])
+                return false;
+        }
+        a.disable_skip_index();
+    }
+    if(pool.stats().free != pool.stats().capacity)
+        return false;
+
+    subtest = "skip index with a full pool";
+    {
+        struct Node
+        {
+            Node* next;
+        };
+        Node nodes[40];
+        for(uint32 i = 0; i < 40; i++)
+            nodes[i].next = (i < 39) ? &nodes[i+1] : nullptr;
+
+        // a pool that never has room, counting how often it's asked
+        struct FullPool
+        {
+            void* realloc(void*, uint32) { attempts++; return nullptr; }
+            void free(void*) { }
+            uint32 attempts = 0;
+        };
+        FullPool full;
+        etk::NodeIndex<Node, FullPool> index(&full);
+        index.enable_skip_index(4);
+        for(uint32 i = 0; i < 40; i += 3)
+        {
+            uint32 n = (i * 7) % 40;
+            if(index.find(nodes, n) != &nodes[n])
+                return false;
+        }
+        if(full.attempts != 1)
+            return false;
+
+        // it tries again once the list has changed
+        index.invalidate();
+        if((index.find(nodes, 20) != &nodes[20]) || (full.attempts != 2))
+            return false;
+    }
+
     return true;
 }
@@ -0,0 +1,133 @@
+#include "intrusive_list_test.h"
+
+#include <etk/etk.h>
+
+using namespace etk;
+
+
+namespace
+{
+    struct ByAge { };
+
+    // an entry that is on a lookup list and an age list at the same time
+    struct Entry : public IntrusiveListHook<>, public IntrusiveListHook<ByAge>
+    {
+        Entry(int k) : key(k) { }
+        int key;
+    };
+
+    template <typename L> bool keys(L& list, const int* expect, uint32 n)
+    {
+        if(list.size() != n)
+            return false;
+        uint32 i = 0;
+        for(auto& e : list)
+        {
+            if(e.key != expect[i++])
+                return false;
+        }
+        return true;
+    }
+}
+
+
+bool intrusive_list_test(std::string& subtest)
+{
+    subtest = "push and iterate";
+    Entry a(1), b(2), c(3), d(4);
+    IntrusiveList<Entry> list;
+    if(!list.empty() || (list.front() != nullptr) || (list.pop_back() != nullptr))
+        return false;
+    list.push_back(b);
+    list.push_back(c);
+    list.push_front(a);
+    list.insert(list.iterator_to(c), d);
+    int order1[] = {1, 2, 4, 3};
+    if(!keys(list, order1, 4) || (list.front() != &a) || (list.back() != &c))
+        return false;
+
+    subtest = "iterate backwards";
+    auto iter = list.end();
+    --iter;
+    if((iter->key != 3) || ((--iter)->key != 4))
+        return false;
+
+    subtest = "remove without the list";
+    d.IntrusiveListHook<>::unlink();
+    int order2[] = {1, 2, 3};
+    if(!keys(list, order2, 3) || d.IntrusiveListHook<>::is_linked())
+        return false;
+    list.remove(a);
+    list.remove(a);
+    int order3[] = {2, 3};
+    if(!keys(list, order3, 2))
+        return false;
+
+    subtest = "pushing a linked object moves it";
+    list.push_back(b);
+    int order4[] = {3, 2};
+    if(!keys(list, order4, 2))
+        return false;
+
+    subtest = "two lists";
+    IntrusiveList<Entry, ByAge> ages;
+    ages.push_back(c);
+    ages.push_back(a);
+    ages.push_back(b);
+    int age_order[] = {3, 1, 2};
+    if(!keys(ages, age_order, 3) || !keys(list, order4, 2))
+        return false;
+    if(ages.pop_front() != &c)
+        return false;
+    if(!keys(list, order4, 2))
+        return false;
+
+    subtest = "erase";
+    auto next = list.erase(list.begin());
+    if((next == list.end()) || (next->key != 2) || (list.size() != 1))
+        return false;
+
+    subtest = "objects from an ObjectArrayAllocator";
+    {
+        ObjectArrayAllocator<Entry, 8> entries;
+        IntrusiveList<Entry> lru;
+        for(int i = 0; i < 8; i++)
+            lru.push_front(*new(entries.alloc()) Entry(10 + i));
+        if(entries.alloc() != nullptr)
+            return false;
+
+        // touching an entry moves it to the front and the oldest falls off the back
+        Entry* e = lru.back();
+        lru.push_front(*lru.back());
+        if((lru.front() != e) || (lru.back()->key != 11))
+            return false;
+        Entry* old = lru.pop_back();
+        old->~Entry();
+        entries.free(old);
+
+        // destroying an object takes it off the list
+        Entry* mid = &*(++lru.begin());
+        mid->~Entry();
+        entries.free(mid);
+        if(lru.size() != 6)
+            return false;
+
+        while(Entry* x = lru.pop_front())
+        {
+            x->~Entry();
+            entries.free(x);
+        }
+        if(entries.available() != 8)
+            return false;
+    }
+
+    subtest = "a destroyed list unlinks everything";
+    {
+        IntrusiveList<Entry> temp;
+        temp.push_back(d);
+    }
+    if(d.IntrusiveListHook<>::is_linked())
+        return false;
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#ifndef INTRUSIVE_LIST_TEST_H
+#define INTRUSIVE_LIST_TEST_H
+
+#include <string>
+
+bool intrusive_list_test(std::string& subtest);
+
+#endif // INTRUSIVE_LIST_TEST_H
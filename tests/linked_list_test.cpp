@@ -0,0 +1,203 @@
+#include "linked_list_test.h"
+
+#include <etk/etk.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace etk;
+
+
+namespace
+{
+    template <typename L> bool same(L& list, std::vector<int>& expect)
+    {
+        if(list.size() != expect.size())
+            return false;
+        uint32 i = 0;
+        for(auto iter = list.begin(); iter; iter++)
+        {
+            if(*iter != expect[i++])
+                return false;
+        }
+        return i == expect.size();
+    }
+}
+
+
+bool linked_list_test(std::string& subtest)
+{
+    static MemPool<1024*64> pool;
+
+    subtest = "tail follows removals";
+    {
+        SingleLinkedList<int, 4> list(&pool);
+        list.append(1);
+        list.append(2);
+        list.remove(list.get(1));
+        list.append(3);
+        std::vector<int> expect = {1, 3};
+        if(!same(list, expect))
+            return false;
+        list.pop_head();
+        list.pop_head();
+        list.append(4);
+        expect = {4};
+        if(!same(list, expect))
+            return false;
+    }
+
+    subtest = "defragment puts nodes in list order";
+    {
+        SingleLinkedList<int, 8> list(&pool);
+        std::vector<int> expect;
+        srand(3);
+        for(int i = 0; i < 200; i++)
+        {
+            uint32 at = expect.size() ? rand() % (expect.size() + 1) : 0;
+            list.insert(i, at);
+            expect.insert(expect.begin() + at, i);
+            if((i % 3) == 0)
+            {
+                uint32 gone = rand() % expect.size();
+                list.remove(list.get(gone));
+                expect.erase(expect.begin() + gone);
+            }
+        }
+        if(!same(list, expect))
+            return false;
+
+        if(!list.defragment())
+            return false;
+        if(!same(list, expect))
+            return false;
+
+        // within each slab, each node follows the one before it
+        uint32 in_order = 0;
+        int* prev = nullptr;
+        for(auto iter = list.begin(); iter; iter++)
+        {
+            if((prev != nullptr) && (&*iter > prev) && ((uint8*)&*iter - (uint8*)prev < 64))
+                in_order++;
+            prev = &*iter;
+        }
+        if(in_order < expect.size() - expect.size()/8 - 1)
+            return false;
+
+        list.append(1000);
+        expect.push_back(1000);
+        if(!same(list, expect))
+            return false;
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "indexed access";
+    {
+        SingleLinkedList<int, 16> list(&pool);
+        std::vector<int> expect;
+        for(int i = 0; i < 300; i++)
+        {
+            list.append(i);
+            expect.push_back(i);
+        }
+        for(uint32 i = 0; i < expect.size(); i++)
+        {
+            if(*list.get(i) != expect[i])
+                return false;
+        }
+        if(list.get(300))
+            return false;
+
+        list.enable_skip_index(16);
+        for(int i = 0; i < 400; i++)
+        {
+            uint32 at = rand() % (expect.size() + 1);
+            if(!list.insert(-i, at))
+                return false;
+            expect.insert(expect.begin() + at, -i);
+
+            uint32 n = rand() % expect.size();
+            if(*list.get(n) != expect[n])
+                return false;
+            if((i % 4) == 0)
+            {
+                list.remove(list.get(n));
+                expect.erase(expect.begin() + n);
+            }
+            if((i % 50) == 0)
+            {
+                list.pop_head();
+                expect.erase(expect.begin());
+            }
+        }
+        if(!same(list, expect))
+            return false;
+        list.append(7);
+        if(*list.get(expect.size()) != 7)
+            return false;
+        list.disable_skip_index();
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "unrolled list";
+    {
+        UnrolledLinkedList<int, 6, 4> list(&pool);
+        std::vector<int> expect;
+        for(int i = 0; i < 20; i++)
+        {
+            list.append(i);
+            expect.push_back(i);
+        }
+        if(!same(list, expect) || (*list.get(13) != 13))
+            return false;
+
+        // inserting in to full nodes splits them
+        for(int i = 0; i < 300; i++)
+        {
+            uint32 at = rand() % (expect.size() + 1);
+            if(!list.insert(100 + i, at))
+                return false;
+            expect.insert(expect.begin() + at, 100 + i);
+        }
+        if(!same(list, expect))
+            return false;
+
+        for(int i = 0; i < 250; i++)
+        {
+            uint32 gone = rand() % expect.size();
+            list.remove(list.get(gone));
+            expect.erase(expect.begin() + gone);
+        }
+        if(!same(list, expect))
+            return false;
+        if(list.pop_head() != expect[0])
+            return false;
+        expect.erase(expect.begin());
+
+        subtest = "unrolled list defragment";
+        if(!list.defragment() || !same(list, expect))
+            return false;
+        for(uint32 i = 0; i < expect.size(); i++)
+        {
+            if(*list.get(i) != expect[i])
+                return false;
+        }
+        list.append(-1);
+        expect.push_back(-1);
+        if(!same(list, expect))
+            return false;
+
+        while(expect.size())
+        {
+            list.remove(list.begin());
+            expect.erase(expect.begin());
+        }
+        if(list.size() != 0 || list.begin())
+            return false;
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#ifndef LINKED_LIST_TEST_H
+#define LINKED_LIST_TEST_H
+
+#include <string>
+
+bool linked_list_test(std::string& subtest);
+
+#endif // LINKED_LIST_TEST_H
@@ -1,6 +1,7 @@
 #include "list_tests.h"
 #include <etk/list.h>
 #include "out.h"
+#include "tracked.h"
 
 #include <iostream>
 using namespace std;
@@ -74,6 +75,49 @@ bool list_test(std::string& subtest)
     if(!etk::compare(p.get_lat(), 34.65, 0.001))
         return false;
 
+    subtest = "emplace and move";
+    {
+        etk::List<Tracked, 8> tl;
+        for(int i = 0; i < 6; i++)
+            tl.emplace_back(i);
+        tl.emplace(0, 10);
+        tl.insert(Tracked(11), 3);
+        tl.remove(1);
+        tl.remove_item(Tracked(4));
+        if(Tracked::copies != 0)
+            return false;
+        if((tl.size() != 6) || (*tl[0].v != 10) || (*tl[2].v != 11) || (*tl[5].v != 5))
+            return false;
+
+        etk::List<Tracked, 8> moved(static_cast<etk::List<Tracked, 8>&&>(tl));
+        if((tl.size() != 0) || (moved.size() != 6) || (Tracked::copies != 0))
+            return false;
+
+        Tracked last = moved.pop_back();
+        if((*last.v != 5) || (Tracked::copies != 0))
+            return false;
+
+        etk::List<Tracked, 8> copied(moved);
+        if((copied.size() != 5) || (Tracked::copies != 5) || (*copied[4].v != 3))
+            return false;
+    }
+    if(Tracked::live != 0)
+        return false;
+
+    subtest = "more than 65535 items with a wide index";
+    {
+        static etk::List<uint32, 100000, uint32> big;
+        for(uint32 i = 0; i < 100000; i++)
+        {
+            if(!big.append(i))
+                return false;
+        }
+        if(big.append(0) || (big.size() != 100000) || (big[99999] != 99999))
+            return false;
+        big.remove(70000);
+        if((big.size() != 99999) || (big[70000] != 70001))
+            return false;
+    }
 
     return true;
 }
@@ -16,11 +16,24 @@
 #include "out.h"
 //#include "linkedlist_test.h"
 #include "pool_test.h"
+#include "mem_pool_test.h"
+#include "tlsf_pool_test.h"
+#include "arena_test.h"
 #include "array_test.h"
 #include "tokeniser_test.h"
+#include "field_splitter_test.h"
 #include "objpool_test.h"
+#include "concurrent_objpool_test.h"
+#include "concurrent_pool_test.h"
 #include "forward_list_test.h"
 #include "dynamic_list_test.h"
+#include "ring_buffer_test.h"
+#include "spsc_ring_buffer_test.h"
+#include "mpmc_queue_test.h"
+#include "stm_test.h"
+#include "linked_list_test.h"
+#include "intrusive_list_test.h"
+#include "parse_test.h"
 
 
 
@@ -52,19 +65,32 @@ int main()
     std::cout << "Version string: " << etk::Version::get_version() << std::endl;
 
     th.add_module(pool_test, "Pool test");
+    th.add_module(mem_pool_test, "MemPool test");
+    th.add_module(tlsf_pool_test, "TLSF pool test");
+    th.add_module(arena_test, "Arena test");
 
 
     th.add_module(test_rope, "Rope Test");
     th.add_module(list_test, "List Test");
     th.add_module(static_string_test, "Static String");
+    th.add_module(parse_test, "Number parsing");
     th.add_module(bits_test, "Bits test");
     th.add_module(limiter_test, "Limiter test");
     th.add_module(navigation_test, "Navigation test");
     th.add_module(array_test, "Array test");
     th.add_module(tokeniser_test, "Tokeniser test");
+    th.add_module(field_splitter_test, "Field splitter");
     th.add_module(objpool_test, "Object pools");
+    th.add_module(concurrent_objpool_test, "Concurrent object pools");
+    th.add_module(concurrent_pool_test, "Concurrent memory pool");
     th.add_module(forward_list_test, "Forward list");
     th.add_module(dynamic_list_test, "Dynamic list");
+    th.add_module(ring_buffer_test, "Ring buffer");
+    th.add_module(spsc_ring_buffer_test, "SPSC ring buffer");
+    th.add_module(mpmc_queue_test, "MPMC queue");
+    th.add_module(stm_test, "Short term memory");
+    th.add_module(linked_list_test, "Linked lists");
+    th.add_module(intrusive_list_test, "Intrusive list");
 
     if(th.run())
         return 0;
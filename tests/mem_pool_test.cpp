@@ -0,0 +1,337 @@
+#include "mem_pool_test.h"
+
+#include <etk/etk.h>
+
+using namespace etk;
+
+
+bool mem_pool_test(std::string& subtest)
+{
+    MemPool<2048, 64> pool;
+
+    subtest = "free merges with both neighbours";
+    void* a = pool.alloc(40);
+    void* b = pool.alloc(40);
+    void* c = pool.alloc(40);
+    void* d = pool.alloc(40);
+    if((a == nullptr) || (b == nullptr) || (c == nullptr) || (d == nullptr))
+        return false;
+
+    pool.free(a);
+    pool.free(c);
+    pool.free(b);
+    // a, b and c are now one free block, so coalesce finds two free blocks
+    // (a+b+c and the tail after d)
+    if(pool.coalesce() != 2)
+        return false;
+
+    void* abc = pool.alloc(64*3 - 64);
+    if(abc != a)
+        return false;
+
+    pool.free(abc);
+    pool.free(d);
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "unref merges on release";
+    a = pool.alloc(100);
+    pool.ref(a);
+    pool.unref(a);
+    pool.unref(a);
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "realloc grows into the previous block";
+    {
+        char* before = (char*)pool.alloc(10);
+        char* grow = (char*)pool.alloc(10);
+        void* after = pool.alloc(10);
+        memcpy(grow, "slide", 6);
+        pool.free(before);
+        // nothing free after it, so it slides down into the freed block
+        char* grown = (char*)pool.realloc(grow, 64);
+        if((grown != before) || (memcmp(grown, "slide", 6) != 0))
+            return false;
+        pool.free(grown);
+        pool.free(after);
+    }
+
+    subtest = "realloc keeps contents";
+    char* s = (char*)pool.alloc(10);
+    memcpy(s, "mempool!", 9);
+    void* blocker = pool.alloc(10);
+    s = (char*)pool.realloc(s, 300);
+    if((s == nullptr) || (memcmp(s, "mempool!", 9) != 0))
+        return false;
+
+    subtest = "failed realloc leaves the block allocated";
+    if(pool.realloc(s, 4000) != nullptr)
+        return false;
+    if(memcmp(s, "mempool!", 9) != 0)
+        return false;
+    pool.free(s);
+    pool.free(blocker);
+
+    subtest = "whole pool available after freeing";
+    void* all = pool.alloc(2048-64);
+    if(all == nullptr)
+        return false;
+    pool.free(all);
+
+    subtest = "small chunks";
+    {
+        // the header of an allocated block is no bigger than it used to be,
+        // so 32 byte chunks still work
+        MemPool<1024, 32> small;
+        void* p[32];
+        uint32 n = 0;
+        while((n < 32) && ((p[n] = small.alloc(4)) != nullptr))
+            n++;
+        if(n != 32)
+            return false;
+        for(uint32 i = 0; i < n; i += 2)
+            small.free(p[i]);
+        for(uint32 i = 1; i < n; i += 2)
+            small.free(p[i]);
+        if(small.coalesce() != 1)
+            return false;
+        if(small.alloc(1024-32) == nullptr)
+            return false;
+    }
+
+    subtest = "many small lists";
+    {
+        DynamicList<int> l0(&pool), l1(&pool), l2(&pool), l3(&pool);
+        DynamicList<int>* lists[4] = { &l0, &l1, &l2, &l3 };
+        for(int i = 0; i < 40; i++)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                if(!lists[j]->append(i))
+                    return false;
+            }
+        }
+        for(int j = 0; j < 4; j++)
+        {
+            for(int i = 0; i < 40; i++)
+            {
+                if((*lists[j])[i] != i)
+                    return false;
+            }
+        }
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "containers with a static pool type";
+    {
+        typedef MemPool<2048, 64> PoolType;
+        DynamicList<int, 4, PoolType> list(&pool);
+        SingleLinkedList<int, 12, PoolType> linked(&pool);
+        for(int i = 0; i < 40; i++)
+        {
+            if(!list.append(i) || !linked.append(i))
+                return false;
+        }
+        int i = 0;
+        for(auto it = linked.begin(); it; it++)
+        {
+            if((*it != i) || (list[i] != i))
+                return false;
+            i++;
+        }
+
+        static int alive = 0;
+        struct Counted
+        {
+            Counted(int v) : v(v) { alive++; }
+            ~Counted() { alive--; }
+            int v;
+        };
+        {
+            auto p = pool_pointer<Counted, PoolType>::make(pool, 7);
+            {
+                auto q = p;
+                if((q->v != 7) || (alive != 1))
+                    return false;
+            }
+            if(alive != 1)
+                return false;
+        }
+        if(alive != 0)
+            return false;
+    }
+    if(pool.coalesce() != 1)
+        return false;
+
+    subtest = "bulk allocation";
+    {
+        void* batch[8];
+        if(!pool.alloc_n(batch, 24, 8))
+            return false;
+        for(int i = 1; i < 8; i++)
+        {
+            // carved from one run, so the blocks are back to back
+            if((uint8*)batch[i] != (uint8*)batch[i-1] + 64)
+                return false;
+        }
+        void* after = pool.alloc(24);
+        if(after != (uint8*)batch[7] + 64)
+            return false;
+
+        pool.free(batch[3]);
+        pool.free_n(batch, 3);
+        pool.free_n(&batch[4], 4);
+        pool.free(after);
+        if(pool.coalesce() != 1)
+            return false;
+
+        if(pool.alloc_n(batch, 300, 8) != false)
+            return false;
+        if(pool.coalesce() != 1)
+            return false;
+    }
+
+    subtest = "object pool allocator";
+    {
+        ObjectPoolAllocator<uint64> objects(&pool);
+        uint64* objs[4];
+        if(!objects.alloc_n(objs, 4))
+            return false;
+        for(int i = 0; i < 4; i++)
+            *objs[i] = i;
+        uint64* one = objects.alloc();
+        if(!objects.free(one) || !objects.free_n(objs, 4))
+            return false;
+        if(pool.coalesce() != 1)
+            return false;
+    }
+
+    subtest = "object array bulk allocation";
+    {
+        ObjectArrayAllocator<uint32, 8> objects;
+        uint32* objs[8];
+        if(!objects.alloc_n(objs, 6))
+            return false;
+        if(objects.alloc_n(&objs[6], 3))
+            return false;
+        if(objects.available() != 2)
+            return false;
+        uint32 stray;
+        uint32* bad[2] = { objs[0], &stray };
+        if(objects.free_n(bad, 2) || (objects.available() != 2))
+            return false;
+        if(!objects.free_n(objs, 6) || (objects.available() != 8))
+            return false;
+        if(!objects.alloc_n(objs, 8))
+            return false;
+    }
+
+    subtest = "allocation trace";
+    {
+        MemPool<1024, 64> tpool;
+        AllocTrace records[4];
+        RingBuffer<AllocTrace, true> trace(records, 4);
+        static uint32 ticks = 0;
+        tpool.set_trace(&trace, []() -> uint32 { return ticks += 5; });
+
+        void* x = tpool.alloc(64);          // 2 chunks
+        x = tpool.realloc(x, 150);          // 3 chunks
+        tpool.alloc(2000);
+        tpool.free(x);
+        if(trace.available() != 3)
+            return false;
+        // the first record was overwritten
+        AllocTrace r = trace.get();
+        if((r.op != AllocTrace::REALLOC) || (r.chunks != 3) || !r.ok || (r.latency != 5))
+            return false;
+        r = trace.get();
+        if((r.op != AllocTrace::ALLOC) || r.ok || (r.size != 2000))
+            return false;
+        r = trace.get();
+        if((r.op != AllocTrace::FREE) || (r.chunks != 3))
+            return false;
+
+        tpool.set_trace(nullptr);
+        tpool.alloc(10);
+        if(trace.available() != 0)
+            return false;
+    }
+
+    subtest = "fragmentation report";
+    {
+        MemPool<1024, 64> fpool;
+        FragmentationReport rep = fpool.fragmentation_report();
+        if((rep.free_chunks != 16) || (rep.free_runs != 1) || 
+                (rep.largest_free_run != 16) || (rep.histogram[4] != 1) ||
+                (rep.external_fragmentation != 0))
+            return false;
+
+        void* p[8];
+        for(int i = 0; i < 8; i++)
+            p[i] = fpool.alloc(10);
+        for(int i = 0; i < 8; i += 2)
+            fpool.free(p[i]);
+        // four single chunk holes and the 8 chunk tail
+        rep = fpool.fragmentation_report();
+        if((rep.free_chunks != 12) || (rep.free_runs != 5) || (rep.largest_free_run != 8))
+            return false;
+        if((rep.histogram[0] != 4) || (rep.histogram[3] != 1))
+            return false;
+        if((rep.external_fragmentation < 0.33) || (rep.external_fragmentation > 0.34))
+            return false;
+    }
+
+#ifndef ETK_NO_POOL_STATS
+    subtest = "pool statistics";
+    {
+        MemPool<1024, 64> spool;
+        PoolStats st = spool.stats();
+        if((st.capacity != 16) || (st.free != 16) || (st.high_water != 0))
+            return false;
+
+        void* x = spool.alloc(64);    // 2 chunks
+        void* y = spool.alloc(10);    // 1 chunk
+        if(spool.stats().free != 13)
+            return false;
+        y = spool.realloc(y, 150);    // grows in place to 3 chunks
+        if(spool.stats().free != 11)
+            return false;
+        y = spool.realloc(y, 10);
+        spool.free(x);
+        if(spool.alloc(2000) != nullptr)
+            return false;
+
+        st = spool.stats();
+        if((st.free != 15) || (st.high_water != 5) || (st.failed_allocs != 1))
+            return false;
+        spool.free(y);
+        if(spool.stats().free != 16)
+            return false;
+    }
+
+    subtest = "object allocator statistics";
+    {
+        ObjectArrayAllocator<uint32, 4> objects;
+        uint32* a = objects.alloc();
+        uint32* b = objects.alloc();
+        if(objects.available() != 2)
+            return false;
+        objects.free(a);
+        objects.alloc();
+        objects.alloc();
+        objects.alloc();
+        if(objects.alloc() != nullptr)
+            return false;
+        PoolStats st = objects.stats();
+        if((st.free != 0) || (st.high_water != 4) || (st.failed_allocs != 1))
+            return false;
+        objects.free(b);
+        if(objects.available() != 1)
+            return false;
+    }
+#endif
+
+    return true;
+}
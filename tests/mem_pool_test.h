@@ -0,0 +1,8 @@
+#ifndef MEM_POOL_TEST_H
+#define MEM_POOL_TEST_H
+
+#include <string>
+
+bool mem_pool_test(std::string& subtest);
+
+#endif // MEM_POOL_TEST_H
@@ -0,0 +1,107 @@
+#include "mpmc_queue_test.h"
+
+#include <etk/etk.h>
+#include <thread>
+#include <vector>
+
+using namespace etk;
+
+
+bool mpmc_queue_test(std::string& subtest)
+{
+    subtest = "capacity is rounded down to a power of two";
+    uint32 items[20];
+    std::atomic<uint32> sequence[20];
+    MpmcQueue<uint32> q(items, sequence, 20);
+    if(q.capacity() != 16)
+        return false;
+
+    subtest = "try_put and try_get";
+    uint32 v;
+    if(q.try_get(v))
+        return false;
+    for(uint32 lap = 0; lap < 3; lap++)
+    {
+        for(uint32 i = 0; i < 16; i++)
+        {
+            if(!q.try_put(i))
+                return false;
+        }
+        if(q.try_put(16) || (q.available() != 16))
+            return false;
+        for(uint32 i = 0; i < 16; i++)
+        {
+            if(!q.try_get(v) || (v != i))
+                return false;
+        }
+        if(q.try_get(v) || (q.available() != 0))
+            return false;
+    }
+
+    subtest = "many producers and consumers";
+    {
+        const uint32 producers = 4;
+        const uint32 consumers = 3;
+        const uint32 per_producer = 100000;
+        static uint32 shared[64];
+        static std::atomic<uint32> shared_seq[64];
+        MpmcQueue<uint32> mq(shared, shared_seq, 64);
+
+        // every value is sent exactly once, tagged with its producer in the
+        // top bits, so the consumers can check that nothing was lost,
+        // duplicated or reordered within a producer
+        std::vector<uint32> received[consumers];
+        std::vector<std::thread> threads;
+        for(uint32 p = 0; p < producers; p++)
+        {
+            threads.push_back(std::thread([&mq, p]() {
+                for(uint32 i = 0; i < per_producer; i++)
+                    mq.put((p << 24) | i);
+            }));
+        }
+        for(uint32 c = 0; c < consumers; c++)
+        {
+            threads.push_back(std::thread([&mq, &received, c]() {
+                for(;;)
+                {
+                    uint32 x = mq.get();
+                    if(x == 0xFFFFFFFF)
+                        break;
+                    received[c].push_back(x);
+                }
+            }));
+        }
+        for(uint32 p = 0; p < producers; p++)
+            threads[p].join();
+        for(uint32 c = 0; c < consumers; c++)
+            mq.put(0xFFFFFFFF);
+        for(uint32 c = 0; c < consumers; c++)
+            threads[producers + c].join();
+
+        std::vector<uint32> seen(producers, 0);
+        uint32 total = 0;
+        for(uint32 c = 0; c < consumers; c++)
+        {
+            std::vector<int32> last(producers, -1);
+            for(uint32 x : received[c])
+            {
+                uint32 p = x >> 24;
+                int32 i = x & 0xFFFFFF;
+                if((p >= producers) || (i <= last[p]))
+                    return false;
+                last[p] = i;
+                seen[p]++;
+                total++;
+            }
+        }
+        if(total != producers * per_producer)
+            return false;
+        for(uint32 p = 0; p < producers; p++)
+        {
+            if(seen[p] != per_producer)
+                return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#ifndef MPMC_QUEUE_TEST_H
+#define MPMC_QUEUE_TEST_H
+
+#include <string>
+
+bool mpmc_queue_test(std::string& subtest);
+
+#endif // MPMC_QUEUE_TEST_H
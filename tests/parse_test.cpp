@@ -0,0 +1,249 @@
+#include "parse_test.h"
+
+#include <etk/etk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace etk;
+
+
+namespace
+{
+    template <typename T> ParseResult parse(const char* s, T& v)
+    {
+        return parse_number(s, s+strlen(s), v);
+    }
+
+    template <typename T> bool same_bits(T a, T b)
+    {
+        return memcmp(&a, &b, sizeof(T)) == 0;
+    }
+
+    uint64 next_random(uint64& seed)
+    {
+        seed = seed*6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 11;
+    }
+
+    // parses s as both float and double and checks them against strtof and strtod
+    bool check_float(const char* s, std::string& subtest)
+    {
+        float f = 0;
+        double d = 0;
+        ParseResult rf = parse(s, f);
+        ParseResult rd = parse(s, d);
+        char* end;
+        float ef = strtof(s, &end);
+        double ed = strtod(s, &end);
+        if(!same_bits(f, ef) || !same_bits(d, ed) || (rf.end != end) || (rd.end != end))
+        {
+            subtest += std::string(" ") + s;
+            return false;
+        }
+        return true;
+    }
+}
+
+
+bool parse_test(std::string& subtest)
+{
+    subtest = "Integers";
+    int32 i = 0;
+    ParseResult r = parse("12345,", i);
+    if((i != 12345) || (r.error != ParseResult::OK) || (*r.end != ','))
+        return false;
+    r = parse("-2147483648", i);
+    if((i != -2147483647-1) || (r.error != ParseResult::OK))
+        return false;
+    r = parse("+7x", i);
+    if((i != 7) || (*r.end != 'x'))
+        return false;
+
+    subtest = "Integer errors";
+    const char* junk = "-x";
+    i = 5;
+    r = parse(junk, i);
+    if((r.error != ParseResult::NO_NUMBER) || (r.end != junk) || (i != 5))
+        return false;
+    r = parse("2147483648", i);
+    if((r.error != ParseResult::OUT_OF_RANGE) || (i != 2147483647))
+        return false;
+    r = parse("-99999999999999999999999", i);
+    if((r.error != ParseResult::OUT_OF_RANGE) || (i != -2147483647-1) || (*r.end != '\0'))
+        return false;
+    uint32 u = 3;
+    r = parse("-1", u);
+    if((r.error != ParseResult::NO_NUMBER) || (u != 3))
+        return false;
+    uint64 u64 = 0;
+    r = parse("18446744073709551615", u64);
+    if((r.error != ParseResult::OK) || (u64 != 0xFFFFFFFFFFFFFFFFULL))
+        return false;
+    r = parse("18446744073709551616", u64);
+    if((r.error != ParseResult::OUT_OF_RANGE) || (u64 != 0xFFFFFFFFFFFFFFFFULL))
+        return false;
+
+    subtest = "Integers against snprintf";
+    uint64 seed = 42;
+    for(uint32 n = 0; n < 100000; n++)
+    {
+        int64 v = int64(next_random(seed) << 11) >> (next_random(seed) % 64);
+        char s[32];
+        snprintf(s, 32, "%lld", (long long)v);
+        int64 got = 0;
+        r = parse(s, got);
+        if((got != v) || (r.error != ParseResult::OK) || (*r.end != '\0'))
+        {
+            subtest += std::string(" ") + s;
+            return false;
+        }
+    }
+
+    subtest = "Floats";
+    float f = 0;
+    r = parse("-12.5e1,", f);
+    if((f != -125.0f) || (*r.end != ','))
+        return false;
+    r = parse("1e+", f);
+    if((f != 1.0f) || (*r.end != 'e'))
+        return false;
+    r = parse(".5", f);
+    if(f != 0.5f)
+        return false;
+    r = parse("5.", f);
+    if((f != 5.0f) || (*r.end != '\0'))
+        return false;
+    junk = ".e5";
+    r = parse(junk, f);
+    if((r.error != ParseResult::NO_NUMBER) || (r.end != junk))
+        return false;
+
+    subtest = "Special floats";
+    r = parse("nan", f);
+    if(!is_nan(f))
+        return false;
+    r = parse("-Infinity", f);
+    if(!is_inf(f) || (f > 0) || (*r.end != '\0'))
+        return false;
+    r = parse("1e39", f);
+    if(!is_inf(f) || (r.error != ParseResult::OUT_OF_RANGE))
+        return false;
+    r = parse("-1e-50", f);
+    if((f != 0.0f) || (r.error != ParseResult::OK))
+        return false;
+
+    subtest = "Rounding halfway cases";
+    const char* halfway[] = {
+        "16777217", "16777219", "3.4028235677973366e38", "3.4028235677973367e38",
+        "1.4012984643e-45", "7.006492321624085e-46", "7.006492321624086e-46",
+        "9007199254740993", "2.2250738585072011e-308", "4.9406564584124654e-324",
+        "1.7976931348623158e308", "0.1", "0.30000000000000004", "123456789012345678",
+        "9007199254740993.0000000000000001", "9007199254740993.00000000000000000000",
+        "16777217.000000000000000000001", "340282356779733661637539395458142568447",
+        "2.47032822920623272088284396434110686182529901307162382212792841250337753635104e-324"
+    };
+    for(auto s : halfway)
+    {
+        if(!check_float(s, subtest))
+            return false;
+    }
+
+    subtest = "Digits past the 19th";
+    {
+        double d;
+        r = parse("9007199254740993.0000000000000001", d);
+        if((d != 9007199254740994.0) || (r.error != ParseResult::OK))
+            return false;
+        r = parse("340282356779733661637539395458142568448", f);
+        if(!is_inf(f) || (r.error != ParseResult::OUT_OF_RANGE))
+            return false;
+
+        // long numbers close to the halfway points between random floats
+        for(uint32 n = 0; n < 20000; n++)
+        {
+            char s[96];
+            u32b bits;
+            bits.u = uint32(next_random(seed)) % 0x7F7FFFFF;
+            u32b above;
+            above.u = bits.u + 1;
+            snprintf(s, 96, "%.*e", int(20 + n % 30), (double(bits.f) + double(above.f))/2);
+            if(!check_float(s, subtest))
+                return false;
+
+            uint64 db = ((next_random(seed) << 11) ^ next_random(seed)) % 0x7FEFFFFFFFFFFFFFULL;
+            double lo, hi;
+            memcpy(&lo, &db, 8);
+            db++;
+            memcpy(&hi, &db, 8);
+            snprintf(s, 96, "%.*Le", int(20 + n % 60), ((long double)lo + (long double)hi)/2);
+            if(!check_float(s, subtest))
+                return false;
+        }
+    }
+
+    subtest = "Floats against strtof and strtod";
+    for(uint32 n = 0; n < 100000; n++)
+    {
+        char s[48];
+        uint64 digits = next_random(seed) % 10000000000000000000ULL;
+        digits >>= next_random(seed) % 60;
+        int32 e = int32(next_random(seed) % 80) - 40;
+        if(n % 4 == 0)
+            e *= 8;
+        snprintf(s, 48, "%llue%d", (unsigned long long)digits, int(e));
+        if(!check_float(s, subtest))
+            return false;
+
+        // and every float written out in full
+        u32b bits;
+        bits.u = uint32(next_random(seed));
+        if(is_nan(bits.f))
+            continue;
+        snprintf(s, 48, "%.9g", bits.f);
+        if(!check_float(s, subtest))
+            return false;
+    }
+
+    subtest = "Parsing fields";
+    const char* line = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+    double values[20];
+    ParseResult::Error errors[20];
+    uint32 n = parse_fields(line, line+strlen(line), ',', values, 20, errors);
+    if(n != 15)
+        return false;
+    if((errors[0] != ParseResult::NO_NUMBER) || (errors[3] != ParseResult::NO_NUMBER) ||
+        (errors[13] != ParseResult::NO_NUMBER) || (errors[14] != ParseResult::NO_NUMBER))
+        return false;
+    if((values[1] != 123519) || (values[2] != 4807.038) || (values[4] != 1131) ||
+        (values[7] != 8) || (values[9] != 545.4) || (values[13] != 0))
+        return false;
+    if(parse_fields(line, line+strlen(line), ',', values, 4) != 4)
+        return false;
+
+    int32 ints[4];
+    line = "1;-2;3*5F";
+    if((parse_fields(line, line+strlen(line), ';', ints, 4) != 3) || (ints[1] != -2) || (ints[2] != 3))
+        return false;
+
+    subtest = "Rope and StaticString";
+    char buf[32];
+    Rope rope(buf, 32, "T=-12.5;99");
+    r = rope.parse(f, 2);
+    if((f != -12.5f) || (*r.end != ';'))
+        return false;
+    if((rope.atoi(8) != 99) || (rope.atof(2) != -12.5f))
+        return false;
+
+    StaticString<32> ss = "$T,21.5,-4,1e3";
+    r = ss.parse(f, 3);
+    if((f != 21.5f) || (r.end != ss.c_str()+7))
+        return false;
+    int a = 0;
+    float b = 0;
+    double c = 0;
+    ss.scan(b, a, c);
+    if((b != 21.5f) || (a != -4) || (c != 1000.0))
+        return false;
+    return true;
+}
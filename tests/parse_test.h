@@ -0,0 +1,8 @@
+#ifndef PARSE_TEST_H
+#define PARSE_TEST_H
+
+#include <string>
+
+bool parse_test(std::string& subtest);
+
+#endif // PARSE_TEST_H
@@ -0,0 +1,81 @@
+#include "ring_buffer_test.h"
+
+#include <etk/etk.h>
+#include <string.h>
+
+using namespace etk;
+
+
+bool ring_buffer_test(std::string& subtest)
+{
+    char memory[10];
+    RingBuffer<char> rb(memory, 10);
+
+    subtest = "put and get";
+    for(char c = 'a'; c < 'h'; c++)
+        rb.put(c);
+    if((rb.available() != 7) || (rb.get() != 'a') || (rb.get() != 'b'))
+        return false;
+
+    subtest = "read spans without wrapping";
+    RingSpans<char> r = rb.read_spans();
+    if((r.first_len != 5) || (r.second_len != 0) || (memcmp(r.first, "cdefg", 5) != 0))
+        return false;
+
+    subtest = "write spans wrap around the end";
+    // start is 2 and end is 7, so the free space is 7..9 and then 0
+    RingSpans<char> w = rb.write_spans();
+    if((w.first_len != 3) || (w.second_len != 1) || (w.first != &memory[7]) || (w.second != &memory[0]))
+        return false;
+    memcpy(w.first, "hij", 3);
+    w.second[0] = 'k';
+    rb.commit(w.size());
+    if(!rb.is_full() || (rb.write_spans().size() != 0))
+        return false;
+
+    subtest = "read spans wrap around the end";
+    r = rb.read_spans();
+    if((r.first_len != 8) || (r.second_len != 1) || (r.second[0] != 'k'))
+        return false;
+    if(memcmp(r.first, "cdefghij", 8) != 0)
+        return false;
+
+    subtest = "consume";
+    rb.consume(6);
+    if((rb.available() != 3) || (rb.get() != 'i'))
+        return false;
+    rb.consume(100);
+    if(rb.available() != 0)
+        return false;
+
+    subtest = "commit is limited to the free space";
+    rb.commit(100);
+    if(rb.available() != 9)
+        return false;
+
+    subtest = "overwrite drops the oldest item";
+    RingBuffer<char, true> ow(memory, 4);
+    for(char c = 'a'; c < 'f'; c++)
+        ow.put(c);
+    if((ow.available() != 3) || (ow.get() != 'c'))
+        return false;
+
+    subtest = "more than 65535 items with a wide index";
+    {
+        static uint32 big_memory[200001];
+        RingBuffer<uint32, false, uint32> big(big_memory, 200001);
+        for(uint32 i = 0; i < 150000; i++)
+            big.put(i);
+        for(uint32 i = 0; i < 100000; i++)
+            big.get();
+        for(uint32 i = 150000; i < 300000; i++)
+            big.put(i);
+        if(!big.is_full() || (big.available() != 200000) || (big.peek_ahead(199999) != 299999))
+            return false;
+        RingSpans<uint32> r = big.read_spans();
+        if((r.first_len != 100001) || (r.second_len != 99999) || (r.first[0] != 100000))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#ifndef RING_BUFFER_TEST_H
+#define RING_BUFFER_TEST_H
+
+#include <string>
+
+bool ring_buffer_test(std::string& subtest);
+
+#endif // RING_BUFFER_TEST_H
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <cstdio>
+#include <cstdlib>
 
 #include <iostream>
 using namespace std;
@@ -275,5 +277,130 @@ bool test_rope(std::string& subtest)
 	{
 		return false;
 	}
+
+    subtest = "Appending 64 bit extremes";
+    char wide[48];
+    etk::Rope wr(wide, 48);
+    wr.clear();
+    wr << numeric_limits<int64>::min();
+    if(wr != "-9223372036854775808")
+        return false;
+    wr.clear();
+    wr << numeric_limits<uint64>::max();
+    if(wr != "18446744073709551615")
+        return false;
+    wr.clear();
+    wr.append(uint64(42), 6);
+    wr.append(int32(-7), 3);
+    if(wr != "000042-007")
+        return false;
+
+    subtest = "Counting digits";
+    uint64 p10 = 1;
+    for(uint32 d = 1; d <= 19; d++)
+    {
+        if((etk::count_digits(p10) != d) || (etk::count_digits(p10*10-1) != d))
+            return false;
+        p10 *= 10;
+    }
+    if((etk::count_digits(uint64(0)) != 1) || (etk::count_digits(numeric_limits<uint64>::max()) != 20))
+        return false;
+
+    subtest = "Formatting integers like snprintf";
+    for(int64 v = -100000; v <= 100000; v += 7)
+    {
+        char expect[32];
+        char got[etk::FORMAT_BUFFER_SIZE];
+        snprintf(expect, 32, "%lld", (long long)(v*v*v));
+        uint32 n = etk::format_int(got, int64(v*v*v));
+        got[n] = '\0';
+        if(std::string(got) != expect)
+            return false;
+    }
+
+    subtest = "Rounding floats";
+    wr.clear();
+    wr.append(0.49999997f, 0);
+    if(wr != "0.")
+        return false;
+    wr.clear();
+    wr.append(2.5, 0);
+    wr.append(-0.004f, 2);
+    if(wr != "3.0.00")
+        return false;
+    wr.clear();
+    wr.append(1e30f, 2);
+    if(wr != "ovr")
+        return false;
+    wr.clear();
+    wr.append(-INFINITY, 2);
+    if(wr != "inf")
+        return false;
+
+    subtest = "Shortest floats";
+    const char* shortest[][2] = {
+        {"0.1", "0.1"}, {"100", "100"}, {"-123.456", "-123.456"},
+        {"1e-7", "1e-7"}, {"0.00001", "0.00001"}, {"3.4028235e38", "3.4028235e38"},
+        {"16777216", "16777216"}, {"1e9", "1e9"}, {"1.4e-45", "1e-45"}
+    };
+    for(auto& sh : shortest)
+    {
+        wr.clear();
+        wr.append(strtof(sh[0], nullptr), etk::SHORTEST);
+        if(wr != sh[1])
+        {
+            subtest += std::string(" ") + sh[0] + " gave " + wide;
+            return false;
+        }
+    }
+
+    subtest = "Shortest floats read back the same";
+    uint32 seed = 12345;
+    for(uint32 i = 0; i < 200000; i++)
+    {
+        seed = seed*1664525 + 1013904223;
+        etk::u32b u;
+        u.u = seed;
+        if(etk::is_nan(u.f) || etk::is_inf(u.f))
+            continue;
+
+        char got[etk::FORMAT_BUFFER_SIZE];
+        uint32 n = etk::format_shortest(got, u.f);
+        got[n] = '\0';
+        if(strtof(got, nullptr) != u.f)
+        {
+            subtest += std::string(" ") + got;
+            return false;
+        }
+
+        // and there's no shorter way to write it
+        std::string digits;
+        for(uint32 c = 0; (got[c] != '\0') && (got[c] != 'e'); c++)
+        {
+            if((got[c] >= '0') && (got[c] <= '9'))
+                digits += got[c];
+        }
+        digits.erase(0, digits.find_first_not_of('0'));
+        digits.erase(digits.find_last_not_of('0')+1);
+        uint32 sig = digits.size();
+        char shorter[32];
+        if(sig > 1)
+        {
+            snprintf(shorter, 32, "%.*g", int(sig-1), u.f);
+            if(strtof(shorter, nullptr) == u.f)
+            {
+                subtest += std::string(" ") + got + " could be " + shorter;
+                return false;
+            }
+        }
+    }
+
+    subtest = "Static string with shortest floats";
+    etk::StaticString<32, etk::SHORTEST> ss;
+    ss += 0.3f;
+    ss += ",";
+    ss += 2.0f;
+    if(ss != "0.3,2")
+        return false;
     return true;
 }
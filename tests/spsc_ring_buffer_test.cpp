@@ -0,0 +1,131 @@
+#include "spsc_ring_buffer_test.h"
+
+#include <etk/etk.h>
+#include <thread>
+
+using namespace etk;
+
+
+bool spsc_ring_buffer_test(std::string& subtest)
+{
+    subtest = "capacity is rounded down to a power of two";
+    uint32 memory[100];
+    SpscRingBuffer<uint32> rb(memory, 100);
+    if(rb.capacity() != 64)
+        return false;
+
+    subtest = "put and get";
+    if(!rb.is_empty() || rb.is_full())
+        return false;
+    for(uint32 i = 0; i < 64; i++)
+    {
+        if(!rb.put(i))
+            return false;
+    }
+    if(!rb.is_full() || rb.put(64))
+        return false;
+    uint32 v;
+    if(!rb.peek(v, 3) || (v != 3))
+        return false;
+    for(uint32 i = 0; i < 64; i++)
+    {
+        if(!rb.get(v) || (v != i))
+            return false;
+    }
+    if(rb.get(v) || rb.peek(v))
+        return false;
+
+    subtest = "bulk read and write across the end of the buffer";
+    uint32 in[50];
+    uint32 out[50];
+    for(uint32 i = 0; i < 50; i++)
+        in[i] = 1000 + i;
+    // the buffer is empty and both indices sit at 64, so 50 items wrap
+    for(uint32 i = 0; i < 40; i++)
+        rb.put(i);
+    for(uint32 i = 0; i < 40; i++)
+        rb.get(v);
+    if(rb.put_n(in, 50) != 50)
+        return false;
+    if(rb.put_n(in, 50) != 14)
+        return false;
+    if(rb.available() != 64)
+        return false;
+    if(rb.get_n(out, 50) != 50)
+        return false;
+    for(uint32 i = 0; i < 50; i++)
+    {
+        if(out[i] != 1000 + i)
+            return false;
+    }
+    if((rb.get_n(out, 50) != 14) || (out[13] != 1013))
+        return false;
+
+    subtest = "spans";
+    {
+        RingSpans<uint32> w = rb.write_spans();
+        // everything has been read and the indices sit at 168, which is slot 40
+        if((w.first != &memory[40]) || (w.first_len != 24) || (w.second_len != 40))
+            return false;
+        for(uint32 i = 0; i < 30; i++)
+        {
+            if(i < w.first_len)
+                w.first[i] = i;
+            else
+                w.second[i - w.first_len] = i;
+        }
+        rb.commit(30);
+        RingSpans<uint32> r = rb.read_spans();
+        if((r.first_len != 24) || (r.second_len != 6) || (r.second[5] != 29))
+            return false;
+        rb.consume(29);
+        if(!rb.get(v) || (v != 29) || !rb.is_empty())
+            return false;
+    }
+
+    subtest = "producer and consumer threads";
+    {
+        const uint32 count = 1000000;
+        static uint32 shared[256];
+        SpscRingBuffer<uint32> q(shared, 256);
+        bool ordered = true;
+
+        std::thread consumer([&]() {
+            uint32 expect = 0;
+            uint32 batch[37];
+            while(expect < count)
+            {
+                uint32 n = q.get_n(batch, 37);
+                for(uint32 i = 0; i < n; i++)
+                {
+                    if(batch[i] != expect++)
+                        ordered = false;
+                }
+            }
+        });
+
+        uint32 next = 0;
+        uint32 batch[23];
+        while(next < count)
+        {
+            if((next % 3) == 0)
+            {
+                if(q.put(next))
+                    next++;
+                continue;
+            }
+            uint32 n = 23;
+            if(count - next < n)
+                n = count - next;
+            for(uint32 i = 0; i < n; i++)
+                batch[i] = next + i;
+            next += q.put_n(batch, n);
+        }
+
+        consumer.join();
+        if(!ordered || !q.is_empty())
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#ifndef SPSC_RING_BUFFER_TEST_H
+#define SPSC_RING_BUFFER_TEST_H
+
+#include <string>
+
+bool spsc_ring_buffer_test(std::string& subtest);
+
+#endif // SPSC_RING_BUFFER_TEST_H
@@ -201,6 +201,73 @@ bool static_string_test(std::string& subtest)
 	if(ss.startsWith("asdf") == false) {
 		return false;
 	}
+
+    subtest = "Length follows appends";
+    StaticString<96> nmea = "$GPGGA";
+    for(int32 i = 0; i < 20; i++)
+    {
+        nmea += ',';
+        nmea += i;
+    }
+    if(nmea.length() != 6+10*2+10*3)
+        return false;
+    if(!nmea.compare("$GPGGA,0,1,2,3,4,5,6,7,8,9,10,", 30))
+        return false;
+
+    nmea = "$PTMP";
+    nmea += ',';
+    nmea += 23.5f;
+    nmea.append(1.0, 3);
+    if((nmea != "$PTMP,23.501.000") || (nmea.length() != 16))
+        return false;
+
+    subtest = "Appending past the end";
+    StaticString<8> small = "abc";
+    small += "defghijk";
+    if((small != "abcdefg") || (small.length() != 7))
+        return false;
+    small += 'z';
+    small += 12;
+    if(small.length() != 7)
+        return false;
+
+    subtest = "Length after writing to the buffer";
+    ss = "Hello";
+    ss[2] = '\0';
+    if(ss.length() != 2)
+        return false;
+    ss = "";
+    ss.get_rope() << "Temp " << 23;
+    if((ss.length() != 7) || (ss != "Temp 23"))
+        return false;
+    ss += "C";
+    if(ss != "Temp 23C")
+        return false;
+
+    subtest = "Length after insert, remove and erase";
+    small = "abcdefg";
+    small.insert('X', 3);
+    if((small != "abcXdef") || (small.length() != 7))
+        return false;
+    small.remove(0);
+    small.erase(4, 2);
+    if(small.length() != 4)
+        return false;
+    small.erase(1, 2);
+    if((small != "bd") || (small.length() != 2))
+        return false;
+    small.remove(5);
+    if(small.length() != 2)
+        return false;
+
+    subtest = "Comparing lengths";
+    StaticString<20> abc = "abc";
+    StaticString<30> abcd = "abcd";
+    if(abc.compare(abcd))
+        return false;
+    abc += 'd';
+    if(!abc.compare(abcd))
+        return false;
     return true;
 }
 
@@ -0,0 +1,174 @@
+#include "stm_test.h"
+
+#include <etk/etk.h>
+#include <stdlib.h>
+
+using namespace etk;
+
+
+namespace
+{
+    // works out the statistics the slow way for comparison
+    template <typename T, uint32 LEN> struct BruteForce
+    {
+        BruteForce()
+        {
+            for(uint32 i = 0; i < LEN; i++)
+                window[i] = T();
+            pos = 0;
+        }
+
+        void put(T t)
+        {
+            window[pos] = t;
+            pos = (pos + 1) % LEN;
+        }
+
+        double mean()
+        {
+            double sum = 0;
+            for(uint32 i = 0; i < LEN; i++)
+                sum += window[i];
+            return sum/LEN;
+        }
+
+        double variance()
+        {
+            double m = mean();
+            double sum = 0;
+            for(uint32 i = 0; i < LEN; i++)
+                sum += (window[i] - m)*(window[i] - m);
+            return sum/LEN;
+        }
+
+        T minimum()
+        {
+            T m = window[0];
+            for(uint32 i = 1; i < LEN; i++)
+                m = (window[i] < m) ? window[i] : m;
+            return m;
+        }
+
+        T maximum()
+        {
+            T m = window[0];
+            for(uint32 i = 1; i < LEN; i++)
+                m = (window[i] > m) ? window[i] : m;
+            return m;
+        }
+
+        T window[LEN];
+        uint32 pos;
+    };
+}
+
+
+bool stm_test(std::string& subtest)
+{
+    subtest = "average";
+    ShortTermMemory<float, 10> plain;
+    plain.fill(2.0f);
+    plain.put(12.0f);
+    if(!compare(plain.average(), 3.0f, 0.0001f))
+        return false;
+
+    subtest = "incremental statistics on floats";
+    {
+        ShortTermMemory<float, 64, uint16, true> stm;
+        BruteForce<float, 64> bf;
+        srand(7);
+        for(uint32 i = 0; i < 5000; i++)
+        {
+            // a slow drift plus noise, with the odd spike
+            float v = (i * 0.01f) + (rand() % 1000) * 0.001f;
+            if((i % 97) == 0)
+                v += 50.0f;
+            stm.put(v);
+            bf.put(v);
+
+            if(!compare(stm.average(), (float)bf.mean(), 0.001f))
+                return false;
+            if((stm.minimum() != bf.minimum()) || (stm.maximum() != bf.maximum()))
+                return false;
+            if(!compare(stm.variance(), bf.variance(), 0.01))
+                return false;
+        }
+    }
+
+    subtest = "incremental statistics on integers";
+    {
+        ShortTermMemory<int32, 512, uint16, true> stm;
+        BruteForce<int32, 512> bf;
+        for(int32 i = 0; i < 3000; i++)
+        {
+            int32 v = (rand() % 2000001) - 1000000;
+            stm.put(v);
+            bf.put(v);
+        }
+        if(stm.average() != (int32)((int64)(bf.mean() * 512) / 512))
+            return false;
+        if((stm.minimum() != bf.minimum()) || (stm.maximum() != bf.maximum()))
+            return false;
+        if(!compare(stm.variance() / bf.variance(), 1.0, 0.000001))
+            return false;
+    }
+
+    subtest = "fill resets the statistics";
+    {
+        ShortTermMemory<float, 8, uint16, true> stm;
+        stm.put(100.0f);
+        stm.fill(-1.0f);
+        if((stm.average() != -1.0f) || (stm.minimum() != -1.0f) || (stm.maximum() != -1.0f) || (stm.variance() != 0))
+            return false;
+        stm.put(7.0f);
+        if((stm.maximum() != 7.0f) || (stm.minimum() != -1.0f) || (stm.average() != 0.0f))
+            return false;
+    }
+
+    subtest = "statistics after empty and increment";
+    {
+        ShortTermMemory<int32, 3, uint16, true> stm;
+        stm.put(5);
+        stm.put(1);
+        stm.empty();
+        stm.put(7);
+        if((stm.minimum() != 0) || (stm.maximum() != 7))
+            return false;
+
+        ShortTermMemory<int32, 3, uint16, true> inc;
+        inc.put(9);
+        inc.increment();
+        inc.put(1);
+        inc.put(2);
+        if(inc.maximum() != 2)
+            return false;
+    }
+    {
+        // mix the three and compare with what's actually in memory
+        ShortTermMemory<int32, 7, uint16, true> stm;
+        for(uint32 i = 0; i < 5000; i++)
+        {
+            uint32 op = rand() % 20;
+            if(op == 0)
+                stm.empty();
+            else if(op < 4)
+                stm.increment();
+            else
+                stm.put((rand() % 2001) - 1000);
+
+            int32 lo = stm.peek_ahead(0);
+            int32 hi = lo;
+            int64 sum = 0;
+            for(auto v : stm)
+            {
+                lo = (v < lo) ? v : lo;
+                hi = (v > hi) ? v : hi;
+                sum += v;
+            }
+            if((stm.minimum() != lo) || (stm.maximum() != hi) || (stm.average() != (int32)(sum/7)))
+                return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#ifndef STM_TEST_H
+#define STM_TEST_H
+
+#include <string>
+
+bool stm_test(std::string& subtest);
+
+#endif // STM_TEST_H
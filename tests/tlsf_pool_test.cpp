@@ -0,0 +1,107 @@
+#include "tlsf_pool_test.h"
+
+#include <etk/etk.h>
+
+using namespace etk;
+
+
+bool tlsf_pool_test(std::string& subtest)
+{
+    TlsfPool<4096, 32> pool;
+
+    subtest = "alloc returns distinct blocks";
+    void* ptrs[16];
+    for(uint32 i = 0; i < 16; i++)
+    {
+        ptrs[i] = pool.alloc(40);
+        if(ptrs[i] == nullptr)
+            return false;
+        memset(ptrs[i], i, 40);
+    }
+    for(uint32 i = 0; i < 16; i++)
+    {
+        if(((uint8*)ptrs[i])[39] != i)
+            return false;
+    }
+
+    subtest = "free merges neighbours";
+    // free every second block, then the rest. the pool must end up as one block
+    for(uint32 i = 0; i < 16; i += 2)
+        pool.free(ptrs[i]);
+    for(uint32 i = 1; i < 16; i += 2)
+        pool.free(ptrs[i]);
+
+    void* all = pool.alloc(4096-32);
+    if(all == nullptr)
+        return false;
+    if(pool.alloc(1) != nullptr)
+        return false;
+    pool.free(all);
+
+    subtest = "realloc keeps contents";
+    char* s = (char*)pool.alloc(10);
+    memcpy(s, "etk-tlsf!", 10);
+    void* blocker = pool.alloc(10);
+    s = (char*)pool.realloc(s, 500);
+    if(s == nullptr)
+        return false;
+    if(memcmp(s, "etk-tlsf!", 10) != 0)
+        return false;
+    s = (char*)pool.realloc(s, 5);
+    if(memcmp(s, "etk-t", 5) != 0)
+        return false;
+    pool.free(blocker);
+    pool.free(s);
+
+    subtest = "realloc failure leaves block intact";
+    s = (char*)pool.alloc(100);
+    memcpy(s, "intact", 7);
+    if(pool.realloc(s, 8000) != nullptr)
+        return false;
+    if(memcmp(s, "intact", 7) != 0)
+        return false;
+
+    subtest = "unref releases the block";
+    pool.ref(s);
+    if(pool.unref(s) != 1)
+        return false;
+    pool.unref(s);
+    all = pool.alloc(4096-32);
+    if(all == nullptr)
+        return false;
+    pool.free(all);
+
+    subtest = "DynamicList on a TlsfPool";
+    {
+        DynamicList<int> list(&pool);
+        for(int i = 0; i < 200; i++)
+            list.append(i);
+        for(int i = 0; i < 200; i++)
+        {
+            if(list[i] != i)
+                return false;
+        }
+        list.remove(3);
+        if((list.size() != 199) || (list[3] != 4))
+            return false;
+    }
+
+    subtest = "SingleLinkedList on a TlsfPool";
+    {
+        SingleLinkedList<int> list(&pool);
+        for(int i = 0; i < 50; i++)
+            list.append(i);
+        if(list.size() != 50)
+            return false;
+        if(*list.get(25) != 25)
+            return false;
+    }
+
+    subtest = "everything returned to the pool";
+    all = pool.alloc(4096-32);
+    if(all == nullptr)
+        return false;
+    pool.free(all);
+
+    return true;
+}
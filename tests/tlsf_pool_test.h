@@ -0,0 +1,8 @@
+#ifndef TLSF_POOL_TEST_H
+#define TLSF_POOL_TEST_H
+
+#include <string>
+
+bool tlsf_pool_test(std::string& subtest);
+
+#endif // TLSF_POOL_TEST_H
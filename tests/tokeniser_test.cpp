@@ -126,5 +126,80 @@ bool tokeniser_test(std::string& subtest)
             count++;
         }
     }
+
+    {
+        subtest = "Tokenising a char array";
+        char line[64] = "$POW0,12,,135*F5";
+        char token[20];
+        auto tok = make_tokeniser(line, ',');
+        const char* expect[] = {"$POW0", "12", "", "135*F5"};
+        for(auto e : expect)
+        {
+            if(!tok.next(token, 20) || (std::string(token) != e))
+                return false;
+        }
+        if(tok.next(token, 20))
+            return false;
+    }
+
+    {
+        subtest = "Token too long";
+        char line[32] = "short,muchtoolongtoken,x";
+        char token[8];
+        auto tok = make_tokeniser(line, ',');
+        if(!tok.next(token, 8) || tok.next(token, 8))
+            return false;
+    }
+
+    {
+        subtest = "Slices";
+        const char* line = "gain 45\nmax_travel 85\nmax_temp 75";
+        auto tok = make_tokeniser(line, 34, '\n');
+        const char* token;
+        uint32 len;
+        if(!tok.next_slice(token, len) || (std::string(token, len) != "gain 45"))
+            return false;
+        if(!tok.next_slice(token, len) || (token != line+8) || (len != 13))
+            return false;
+        if(!tok.next_slice(token, len) || (std::string(token, len) != "max_temp 75"))
+            return false;
+        if(tok.next_slice(token, len))
+            return false;
+    }
+
+    {
+        subtest = "Stopping at the end of the buffer";
+        const char line[6] = {'a', 'b', ',', 'c', 'd', 'e'};
+        auto tok = make_tokeniser(line, 5, ',');
+        const char* token;
+        uint32 len;
+        tok.next_slice(token, len);
+        if(!tok.next_slice(token, len) || (std::string(token, len) != "cd"))
+            return false;
+        if(tok.next_slice(token, len))
+            return false;
+    }
+
+    {
+        subtest = "Finding delimiters in long lines";
+        char line[200];
+        for(uint32 len = 0; len < 150; len++)
+        {
+            for(uint32 at = 0; at <= len; at++)
+            {
+                for(uint32 i = 0; i < len; i++)
+                    line[i] = 'a' + (i % 26);
+                line[len] = '\0';
+                if(at < len)
+                    line[at] = (at % 3 == 0) ? '\0' : ';';
+
+                const char* naive = line;
+                while((naive < line+len) && (*naive != ';') && (*naive != '\0'))
+                    naive++;
+                if(find_delimiter(line, line+len, ';') != naive)
+                    return false;
+            }
+        }
+    }
     return true;
 }
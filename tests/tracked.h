@@ -0,0 +1,31 @@
+#ifndef TRACKED_H_INCLUDED
+#define TRACKED_H_INCLUDED
+
+
+namespace
+{
+    // counts copies and live objects so the tests can see how containers handle them
+    struct Tracked
+    {
+        static int live;
+        static int copies;
+
+        Tracked() : v(new int(0)) { live++; }
+        Tracked(int v) : v(new int(v)) { live++; }
+        Tracked(const Tracked& t) : v(new int(*t.v)) { live++; copies++; }
+        Tracked(Tracked&& t) : v(t.v) { t.v = nullptr; live++; }
+        ~Tracked() { delete v; live--; }
+
+        Tracked& operator = (const Tracked& t) { *v = *t.v; copies++; return *this; }
+
+        bool operator == (const Tracked& t) const { return *v == *t.v; }
+
+        int* v;
+    };
+
+    int Tracked::live = 0;
+    int Tracked::copies = 0;
+}
+
+
+#endif // TRACKED_H_INCLUDED